@@ -55,6 +55,7 @@ JCToLuaValue JValue_solvePath(handle context, handle obj, cstring path);
 JCToLuaValue JArray_getValue(handle obj, index key);
 void JArray_setValue(handle obj, index key, const JCValue* val);
 void JArray_insert(handle obj, JCValue* val, index key);
+index JArray_getRange(handle obj, index from, index to, JCToLuaValue* out);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -62,6 +63,11 @@ void JMap_setValue(handle, cstring key, const JCValue* val);
 JCToLuaValue JMap_getValue(handle, cstring key);
 CString JMap_nextKey(handle, cstring lastKey);
 
+// the object stays locked in between, strings point into it. See lua_native_funcs.hpp
+void JValue_borrowBegin(handle obj);
+void JValue_borrowEnd(handle obj);
+index JMap_getEntries(handle, cstring lastKey, JCToLuaValue* keys, JCToLuaValue* values, index capacity);
+
 //////////////////////////////////////////////////////////////////////////
 
 CForm JFormMap_nextKey(handle obj, CForm lastKey);
@@ -181,11 +181,20 @@ local function makeEvalLuaFunction()
   local jc_function_cache = {}
   setmetatable(jc_function_cache, {__mode = 'v' })
 
-  -- Caches compiled JValue.evalLua* string (weak cache).
+  -- Bytecode cache shared by all Lua contexts (strong), supplied by JC
+  local loadCachedChunk = JC_loadCachedChunk or function() return nil end
+  local cacheChunk = JC_cacheChunk or function() end
+
+  -- Caches compiled JValue.evalLua* string (weak cache). Falls back to the shared bytecode cache,
+  -- so a string is parsed once per game session, not once per context
   local function compileAndCache (luaString)
     local func = jc_function_cache[luaString]
     if not func then
-      local f, message = loadstring('local args = ...; local jobject = args;' .. luaString)
+      local f, message = loadCachedChunk(luaString)
+      if not f then
+        f, message = loadstring('local args = ...; local jobject = args;' .. luaString)
+        if f then cacheChunk(luaString, string.dump(f)) end
+      end
       if f then
         func = f
         setfenv(f, evallua_sandbox)
@@ -204,9 +204,11 @@ local JCValueType = {
   string = 6,
 }
 
+local JCToLuaValueArray = ffi.typeof('JCToLuaValue[?]')
+
 -- Converts and returns JCToLuaValue as a lua type (string, number) or as a CForm, JCObject
--- Also frees JCToLuaValue's underlying string
-local function returnLuaValue(item)
+-- Also frees JCToLuaValue's underlying string unless it's @borrowed
+local function returnLuaValue(item, borrowed)
   local tp = item.type
   local v
 
@@ -214,7 +216,7 @@ local function returnLuaValue(item)
     --v = nil
   elseif tp == JCValueType.string then
     v = ffi.string(item.string, item.stringLength)
-    jclib.JCToLuaValue_free(item)
+    if not borrowed then jclib.JCToLuaValue_free(item) end
   elseif tp == JCValueType.integer then
     v = item.integer
   elseif tp == JCValueType.real then
@@ -341,12 +343,32 @@ do
     jclib.JArray_setValue(optr.___id, convertIndex(idx), returnJCValue(value))
   end
 
+  local rangeSize = 1024
+
+  -- reads the values in ranges: one lock and one JArray_getRange call per @rangeSize values
   function JArray.__ipairs (optr)
+    local handle = optr.___id
+    local buffer = JCToLuaValueArray(rangeSize)
+    local range, from, count = {}, 0, 0
+
+    local function convertRange()
+      count = jclib.JArray_getRange(handle, from, from + rangeSize, buffer)
+      for i = 0, count - 1 do
+        range[i + 1] = returnLuaValue(buffer[i], true)
+      end
+    end
+
     local iterator = function(optr, idx)
       idx = idx + 1
-      if idx <= #optr then
-        return idx, optr[idx]
+      if idx > from + count then
+        from = idx - 1
+        jclib.JValue_borrowBegin(handle)
+        local ok, message = pcall(convertRange)
+        jclib.JValue_borrowEnd(handle)
+        if not ok then error(message) end
+        if count == 0 then return nil end
       end
+      return idx, range[idx - from]
     end
     
     return iterator, optr, 0
@@ -381,17 +403,42 @@ do
     end
   end
 
+  local pairsBatchSize = 256
+
+  -- fetches the pairs in batches: the map stays locked only while a batch is converted,
+  -- the strings are borrowed from the map instead of being copied and freed one by one
   function JMap.__pairs (optr)
-    local function iterator (optr, key)
-      -- nextKey is CString cdata which must be freed
-      local nextKey = jclib.JMap_nextKey(optr.___id, key)
-      if nextKey.str ~= nil then
-        local luaString = ffi.string(nextKey.str, nextKey.length)
-        jclib.CString_free(nextKey)
-        return luaString, optr[luaString]
+    local handle = optr.___id
+    local keys, values = JCToLuaValueArray(pairsBatchSize), JCToLuaValueArray(pairsBatchSize)
+    local batchKeys, batchValues = {}, {}
+    local count, position, lastKey, finished = 0, 0, nil, false
+
+    local function convertBatch()
+      count = jclib.JMap_getEntries(handle, lastKey, keys, values, pairsBatchSize)
+      for i = 0, count - 1 do
+        batchKeys[i + 1] = ffi.string(keys[i].string, keys[i].stringLength)
+        batchValues[i + 1] = returnLuaValue(values[i], true)
       end
     end
 
+    local function iterator ()
+      if position == count then
+        if finished then return nil end
+
+        jclib.JValue_borrowBegin(handle)
+        local ok, message = pcall(convertBatch)
+        jclib.JValue_borrowEnd(handle)
+        if not ok then error(message) end
+
+        position, finished = 0, count < pairsBatchSize
+        if count == 0 then return nil end
+        lastKey = batchKeys[count]
+      end
+
+      position = position + 1
+      return batchKeys[position], batchValues[position]
+    end
+
     return iterator, optr, nil
   end
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "util/util.h"
+
+/**
+ * Timings of the Papyrus-facing layer: 1..16 threads reading one JMap through the API and the argument conversion
+ * of a call. The core operations are timed in collections/benchmarks.hpp. Filter them with *_perft
+ */
+
+#ifndef TEST_COMPILATION_DISABLED
+
+namespace tes_api_3 {
+
+    namespace benchmarks {
+
+        static const int reader_counts[] = { 1, 2, 4, 8, 16 };
+    }
+
+    // Many scripts polling one config map: the total time stays flat while the readers share the map's lock
+    JC_TEST(benchmarks, contended_reads_perft)
+    {
+        const int keys = 100, reads_per_thread = 200000;
+        map* config = tes_object::object<map>(context);
+        std::vector<std::string> names;
+        for (int i = 0; i < keys; ++i) {
+            names.push_back("option_" + std::to_string(i));
+            tes_map::setItem<SInt32>(context, config, names.back().c_str(), i);
+        }
+
+        for (int readers : benchmarks::reader_counts) {
+            std::atomic<int> matched{ 0 };
+            const std::string name = "JMap.getInt, " + std::to_string(readers) + " threads x" + std::to_string(reads_per_thread);
+            util::do_with_timing(name.c_str(), [&]() {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < readers; ++t) {
+                    threads.emplace_back([&, t]() {
+                        int own = 0;
+                        for (int i = 0; i < reads_per_thread; ++i) {
+                            const int key = (i + t) % keys;
+                            own += tes_map::getItem<SInt32>(context, config, names[key].c_str()) == key;
+                        }
+                        matched += own;
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            });
+            EXPECT_EQ(readers * reads_per_thread, matched.load());
+        }
+    }
+
+    // the argument conversion of a Papyrus call: a counted reference vs the borrowed pointer
+    JC_TEST(benchmarks, borrowed_args_perft)
+    {
+        using converter = reflection::binding::ObjectConverter<map>;
+        const int calls_per_thread = 500000;
+        const HandleT hdl = (HandleT)tes_object::object<map>(context)->uid();
+
+        for (int threads_count : benchmarks::reader_counts) {
+            std::atomic<int> resolved{ 0 };
+            auto run = [&](const char* kind, auto&& convert) {
+                const std::string name = std::string(kind) + ", " + std::to_string(threads_count) + " threads x" + std::to_string(calls_per_thread);
+                util::do_with_timing(name.c_str(), [&]() {
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < threads_count; ++t) {
+                        threads.emplace_back([&]() {
+                            int own = 0;
+                            for (int i = 0; i < calls_per_thread; ++i) {
+                                own += convert() != nullptr;
+                            }
+                            resolved += own;
+                        });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                });
+            };
+
+            run("stack reference", [&]() { return converter::convert2J(hdl, context).get(); });
+            run("borrowed", [&]() { util::epoch::guard pin; return converter::borrow2J(hdl, context); });
+            EXPECT_EQ(2 * threads_count * calls_per_thread, resolved.load());
+        }
+    }
+}
+
+#endif
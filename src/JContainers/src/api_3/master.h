@@ -14,6 +14,7 @@ namespace tes_api_3 {
 #include "api_3/tes_object.h"
 #include "api_3/tes_atomic.h"
 #include "api_3/tes_array.h"
+#include "api_3/tes_numeric_array.h"
 #include "api_3/tes_map.h"
 #include "api_3/tes_db.h"
 #include "api_3/tes_jcontainers.h"
@@ -22,3 +23,4 @@ namespace tes_api_3 {
 #include "api_3/tes_lua.h"
 
 #include "api_3/tests.hpp"
+#include "api_3/benchmarks.hpp"
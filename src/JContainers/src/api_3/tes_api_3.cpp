@@ -16,6 +16,7 @@
 
 #include "gtest.h"
 #include "util/util.h"
+#include "util/profiling.h"
 #include "jcontainers_constants.h"
 
 #include "skse/string.h"
@@ -33,6 +34,7 @@
 
 #include "collections/bind_traits.h"
 #include "collections/tests.h"
+#include "collections/benchmarks.hpp"
 
 #include "api_3/master.h"
 
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "skse64/GameForms.h"
+
 #include "collections/functions.h"
+#include "collections/query.h"
+#include "util/scan_kernels.h"
 
 namespace tes_api_3 {
 
@@ -26,15 +30,15 @@ namespace tes_api_3 {
 
         // TODO: are these to go to private, all used?
         static bool validateReadIndex(const array *obj, UInt32 index) {
-            return obj && index < obj->_array.size();
+            return obj && index < obj->u_count();
         }
 
         static bool validateReadIndexRange(const array *obj, UInt32 begin, UInt32 end) {
-            return obj && begin < end && end <= obj->_array.size();
+            return obj && begin < end && end <= obj->u_count();
         }
 
         static bool validateWriteIndex(const array *obj, UInt32 index) {
-            return obj && index <= obj->_array.size();
+            return obj && index <= obj->u_count();
         }
 
         typedef array::Index Index;
@@ -50,7 +54,7 @@ namespace tes_api_3 {
 
             auto& obj = array::objectWithInitializer ([&] (array &me)
             {
-                me._array.resize (size);
+                me.u_container().resize (size);
             }
             , ctx);
 
@@ -98,7 +102,7 @@ objectWithBooleans converts booleans into integers");
             }
 
             auto obj = &array::objectWithInitializer([&](array &me) {
-                me._array.insert(me.begin(), source->begin() + startIndex, source->begin() + endIndex);
+                me.u_container().insert(me.begin(), source->begin() + startIndex, source->begin() + endIndex);
             },
                 ctx);
 
@@ -114,11 +118,10 @@ objectWithBooleans converts booleans into integers");
                 return ;
             }
 
-            object_lock g2(another);
-
-            doWriteOp(obj, insertAtIndex, [&obj, &another](uint32_t whereTo) {
-                obj->_array.insert(obj->begin() + whereTo, another->begin(), another->end());
-            });
+            object_lock_pair g(*obj, *another);
+            if (auto whereTo = convertWriteIndex(obj, insertAtIndex)) {
+                obj->u_container().insert(obj->begin() + *whereTo, another->begin(), another->end());
+            }
         }
         REGISTERF2(addFromArray, "* source insertAtIndex=-1",
 "Inserts the values from the source array into this array. If insertAtIndex is -1 (default behaviour) it appends to the end.\n"
@@ -158,17 +161,17 @@ NEGATIVE_IDX_COMMENT);
             JC_LOG_API ("%p, %d, ...", (void*) obj, index);
 
             doReadOp(obj, index, [=, &t](uint32_t idx) {
-                t = obj->_array[idx].readAs<T>();
+                obj->u_read_at(idx, [&t](const item& itm) { t = itm.readAs<T>(); });
             });
 
             return t;
         }
-        REGISTERF(itemAtIndex<SInt32>, "getInt", "* index default=0", "Returns the item at the index of the array.\n"
+        REGISTERF_BORROWED(itemAtIndex<SInt32>, "getInt", "* index default=0", "Returns the item at the index of the array.\n"
             NEGATIVE_IDX_COMMENT);
-        REGISTERF(itemAtIndex<Float32>, "getFlt", "* index default=0.0", "");
-        REGISTERF(itemAtIndex<skse::string_ref>, "getStr", "* index default=\"\"", "");
-        REGISTERF(itemAtIndex<object_base*>, "getObj", "* index default=0", "");
-        REGISTERF(itemAtIndex<form_ref>, "getForm", "* index default=None", "");
+        REGISTERF_BORROWED(itemAtIndex<Float32>, "getFlt", "* index default=0.0", "");
+        REGISTERF_BORROWED(itemAtIndex<skse::string_ref>, "getStr", "* index default=\"\"", "");
+        REGISTERF_BORROWED(itemAtIndex<object_base*>, "getObj", "* index default=0", "");
+        REGISTERF_BORROWED(itemAtIndex<form_ref>, "getForm", "* index default=None", "");
 
         template<class Vector>
         static Vector all_items (tes_context& ctx, ref obj)
@@ -182,10 +185,11 @@ NEGATIVE_IDX_COMMENT);
                 return v;
 
             object_lock lck (obj);
-            v.reserve (obj->_array.size ());
+            const uint32_t count = obj->u_count ();
+            v.reserve (count);
 
-            for (auto& i : obj->_array)
-                v.emplace_back (i.readAs<T> ());
+            for (uint32_t i = 0; i < count; ++i)
+                obj->u_read_at (i, [&v] (const item& itm) { v.emplace_back (itm.readAs<T> ()); });
 
             return v;
         }
@@ -197,6 +201,18 @@ NEGATIVE_IDX_COMMENT);
         REGISTERF (all_items<VMResultArray<skse::string_ref>>, "asStringArray", "*", "");
         REGISTERF (all_items<VMResultArray<TESForm*>>,         "asFormArray",   "*", "");
 
+        // Packed arrays are scanned with SIMD kernels, see util/scan_kernels.h
+        template<class Values, class T>
+        static SInt32 packed_find(const Values& vals, uint32_t idx, T value, bool backwards) {
+            using V = typename Values::value_type;
+            if (!backwards) {
+                const size_t found = util::scan::find(vals.data() + idx, vals.size() - idx, (V)value);
+                return found != vals.size() - idx ? (SInt32)(idx + found) : -1;
+            }
+            const size_t found = util::scan::rfind(vals.data(), idx + 1, (V)value);
+            return found != idx + 1 ? (SInt32)found : -1;
+        }
+
         template<class T>
         static SInt32 findVal(tes_context& ctx, ref obj, T value, SInt32 pySearchStartIndex = 0)
         {
@@ -205,26 +221,36 @@ NEGATIVE_IDX_COMMENT);
             int result = -1;
 
             doReadOp(obj, pySearchStartIndex, [=, &result](uint32_t idx) {
+                if constexpr (array::is_packable<T>) {
+                    if (auto vals = obj->u_packed<T>()) {
+                        result = packed_find(*vals, idx, value, pySearchStartIndex < 0);
+                        return;
+                    }
+                }
+                if (obj->u_layout() != array::layout::items) {
+                    return; // packed with values of another type, nothing to find
+                }
+
                 if (pySearchStartIndex >= 0) {
                     auto itr = std::find(obj->begin() + idx, obj->end(), item(value));
                     result = itr != obj->end() ? (itr - obj->begin()) : -1;
                 } else {
                     auto itr = std::find(obj->rbegin() + (-pySearchStartIndex - 1), obj->rend(), item(value));
-                    result = itr != obj->rend() ? (obj->rend() - itr) : -1;
+                    result = itr != obj->rend() ? (obj->rend() - itr - 1) : -1;
                 }
             });
 
             return result;
         }
-        REGISTERF(findVal<SInt32>, "findInt", "* value searchStartIndex=0",
+        REGISTERF_BORROWED(findVal<SInt32>, "findInt", "* value searchStartIndex=0",
 "Returns the index of the first found value/container that equals to given the value/container (default behaviour if searchStartIndex is 0).\n\
 If nothing was found it returns -1.\n\
 @searchStartIndex - index of the array where to start search\n"
 NEGATIVE_IDX_COMMENT);
-        REGISTERF(findVal<Float32>, "findFlt", "* value searchStartIndex=0", "");
-        REGISTERF(findVal<const char *>, "findStr", "* value searchStartIndex=0", "");
+        REGISTERF_BORROWED(findVal<Float32>, "findFlt", "* value searchStartIndex=0", "");
+        REGISTERF_BORROWED(findVal<const char *>, "findStr", "* value searchStartIndex=0", "");
         REGISTERF(findVal<object_base*>, "findObj", "* container searchStartIndex=0", "");
-        REGISTERF(findVal<form_ref>, "findForm", "* value searchStartIndex=0", "");
+        REGISTERF_BORROWED(findVal<form_ref>, "findForm", "* value searchStartIndex=0", "");
 
         template<class T>
         static SInt32 count_item (tes_context& ctx, ref obj, T value)
@@ -235,16 +261,25 @@ NEGATIVE_IDX_COMMENT);
             if (obj) 
             {
                 object_lock g (obj);
+                if constexpr (array::is_packable<T>) {
+                    if (auto vals = obj->u_packed<T>()) {
+                        using V = typename std::remove_pointer_t<decltype(vals)>::value_type;
+                        return static_cast<SInt32> (util::scan::count (vals->data (), vals->size (), (V)value));
+                    }
+                }
+                if (obj->u_layout () != array::layout::items) {
+                    return 0;
+                }
                 auto n = std::count (obj->u_container ().begin (), obj->u_container ().end (), item (value));
                 result = static_cast<SInt32> (n);
             }
             return result;
         }
-        REGISTERF (count_item<SInt32>, "countInteger", "* value", "Returns the number of times given value was found in a JArray.");
-        REGISTERF (count_item<Float32>, "countFloat", "* value", "");
-        REGISTERF (count_item<const char *>, "countString", "* value", "");
+        REGISTERF_BORROWED(count_item<SInt32>, "countInteger", "* value", "Returns the number of times given value was found in a JArray.");
+        REGISTERF_BORROWED(count_item<Float32>, "countFloat", "* value", "");
+        REGISTERF_BORROWED(count_item<const char *>, "countString", "* value", "");
         REGISTERF (count_item<object_base*>, "countObject", "* container", "");
-        REGISTERF (count_item<form_ref>, "countForm", "* value", "");
+        REGISTERF_BORROWED(count_item<form_ref>, "countForm", "* value", "");
 
         template<class T>
         static void replaceItemAtIndex(tes_context& ctx, ref obj, Index index, T val)
@@ -252,7 +287,9 @@ NEGATIVE_IDX_COMMENT);
             JC_LOG_API ("%p, %d, ...", (void*) obj, index);
 
             doReadOp(obj, index, [=](uint32_t idx) {
-                obj->_array[idx] = item(val);
+                if (!obj->u_try_set_packed(idx, val)) {
+                    obj->u_container()[idx] = item(val);
+                }
             });
         }
         REGISTERF(replaceItemAtIndex<SInt32>, "setInt", "* index value", "Replaces existing value at the @index of the array with the new @value.\n"
@@ -268,7 +305,9 @@ NEGATIVE_IDX_COMMENT);
             JC_LOG_API ("%p, ..., %d", (void*) obj, addToIndex);
 
             doWriteOp(obj, addToIndex, [&](uint32_t idx) {
-                (void)obj->_array.emplace(obj->begin() + idx, val);
+                if (!obj->u_try_insert_packed(idx, val)) {
+                    (void)obj->u_container().emplace(obj->begin() + idx, val);
+                }
             });
         }
         REGISTERF(addItemAt<SInt32>, "addInt", "* value addToIndex=-1", "Appends the @value/@container to the end of the array.\n\
@@ -282,7 +321,7 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
             JC_LOG_API ("%p", (void*) obj);
             return tes_object::count(ctx, obj);
         }
-        REGISTERF2(count, "*", "Returns count of the items in the array");
+        REGISTERF2_BORROWED(count, "*", "Returns count of the items in the array");
 
         static void clear(tes_context& ctx, ref obj) {
             JC_LOG_API ("%p", (void*) obj);
@@ -295,7 +334,7 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
             JC_LOG_API ("%p, %d", (void*) obj, index);
 
             doReadOp(obj, index, [=](uint32_t idx) {
-                obj->_array.erase(obj->begin() + idx);
+                obj->u_erase_range(idx, idx + 1);
             });
         }
         REGISTERF2(eraseIndex, "* index", "Erases the item at the index. "NEGATIVE_IDX_COMMENT);
@@ -311,7 +350,7 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
             SInt32 pyIndexes[] { first, last };
             doReadOp(obj, pyIndexes, [=](const std::array<uint32_t, 2>& indices) {
                 if (indices[0] <= indices[1]) {
-                    obj->_array.erase(obj->begin() + indices[0], obj->begin() + indices[1] + 1);
+                    obj->u_erase_range(indices[0], indices[1] + 1);
                 }
             });
         }
@@ -327,6 +366,18 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
             if (obj) 
             {
                 object_lock g (obj);
+                if constexpr (array::is_packable<T>) {
+                    if (auto vals = obj->u_packed<T>()) {
+                        using V = typename std::remove_pointer_t<decltype(vals)>::value_type;
+                        const size_t left = util::scan::remove (vals->data (), vals->size (), (V)value);
+                        result = static_cast<SInt32> (vals->size () - left);
+                        vals->resize (left);
+                        return result;
+                    }
+                }
+                if (obj->u_layout () != array::layout::items) {
+                    return 0;
+                }
                 auto new_end = std::remove (obj->u_container ().begin (), obj->u_container ().end (), item (value));
                 result = static_cast<SInt32> (std::distance (new_end, obj->u_container ().end ()));
                 obj->u_container ().erase (new_end, obj->u_container ().end ());
@@ -345,12 +396,12 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
 
             SInt32 type = item_type::no_item;
             doReadOp(obj, index, [=, &type](uint32_t idx) {
-                type = obj->_array[idx].type();
+                obj->u_read_at(idx, [&type](const item& itm) { type = itm.type(); });
             });
 
             return type;
         }
-        REGISTERF2(valueType, "* index", "Returns type of the value at the @index. "NEGATIVE_IDX_COMMENT"\n"VALUE_TYPE_COMMENT);
+        REGISTERF2_BORROWED(valueType, "* index", "Returns type of the value at the @index. "NEGATIVE_IDX_COMMENT"\n"VALUE_TYPE_COMMENT);
 
         static void swapItems(tes_context& ctx, ref obj, SInt32 idx, SInt32 idx2)
         {
@@ -404,6 +455,109 @@ If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
         }
         REGISTERF2 (reverse, "*", "Reverse the order of elements. Returns the array itself.");
 
+#define QUERY_COMMENT "@path is resolved against each value (\"\" - the value itself, \".gold\", \"[0].name\" - in the value's container).\n"\
+    "@comparison is one of \"==\", \"!=\", \"<\", \"<=\", \">\", \">=\". Numbers (int and float) compare as numbers, strings case-insensitively,\n"\
+    "forms and objects are equal or not. Values of other types only satisfy \"!=\". Large arrays are split across several threads"
+
+        template<class T>
+        static object_base* filterBy(tes_context& ctx, ref obj, const char *path, const char *comparison, T value)
+        {
+            JC_LOG_API ("%p, %s, %s, ...", (void*) obj, path ? path : "", comparison ? comparison : "");
+
+            auto op = query::parse_comparison(comparison);
+            if (!obj || !op) {
+                return nullptr;
+            }
+
+            auto values = query::values_of(*obj);
+            auto filtered = query::filter(ctx, values, path, *op, item(value));
+            return &array::objectWithInitializer([&](array& me) {
+                me.u_container() = std::move(filtered);
+            },
+                ctx);
+        }
+        REGISTERF(filterBy<SInt32>, "filterByInt", "* path comparison value",
+            "Returns a new array of the values whose @path value satisfies the @comparison with the @value. None if the @comparison is unknown.\n"
+            QUERY_COMMENT);
+        REGISTERF(filterBy<Float32>, "filterByFlt", "* path comparison value", "");
+        REGISTERF(filterBy<const char *>, "filterByStr", "* path comparison value", "");
+        REGISTERF(filterBy<form_ref>, "filterByForm", "* path comparison value", "");
+
+        template<class T>
+        static SInt32 countIf(tes_context& ctx, ref obj, const char *path, const char *comparison, T value)
+        {
+            JC_LOG_API ("%p, %s, %s, ...", (void*) obj, path ? path : "", comparison ? comparison : "");
+
+            auto op = query::parse_comparison(comparison);
+            if (!obj || !op) {
+                return 0;
+            }
+
+            auto values = query::values_of(*obj);
+            return (SInt32)query::count_if(ctx, values, path, *op, item(value));
+        }
+        REGISTERF(countIf<SInt32>, "countIfInt", "* path comparison value",
+            "Returns the number of values whose @path value satisfies the @comparison with the @value. See filterByInt");
+        REGISTERF(countIf<Float32>, "countIfFlt", "* path comparison value", "");
+        REGISTERF(countIf<const char *>, "countIfStr", "* path comparison value", "");
+        REGISTERF(countIf<form_ref>, "countIfForm", "* path comparison value", "");
+
+        static Float32 sumByPath(tes_context& ctx, ref obj, const char *path = "")
+        {
+            JC_LOG_API ("%p, %s", (void*) obj, path ? path : "");
+            if (!obj) {
+                return 0.f;
+            }
+            auto values = query::values_of(*obj);
+            return (Float32)query::summarize(ctx, values, path).sum;
+        }
+        REGISTERF2(sumByPath, "* path=\"\"", "Returns the sum of the numbers at the @path of each value. Non-numbers are skipped. See filterByInt");
+
+        static Float32 avgByPath(tes_context& ctx, ref obj, const char *path = "")
+        {
+            JC_LOG_API ("%p, %s", (void*) obj, path ? path : "");
+            if (!obj) {
+                return 0.f;
+            }
+            auto values = query::values_of(*obj);
+            auto summary = query::summarize(ctx, values, path);
+            return summary.count ? (Float32)(summary.sum / summary.count) : 0.f;
+        }
+        REGISTERF2(avgByPath, "* path=\"\"", "Returns the average of the numbers at the @path of each value or 0 if there are none");
+
+        static ref sortByPath(tes_context& ctx, ref obj, const char *path, bool ascending = true)
+        {
+            JC_LOG_API ("%p, %s, %d", (void*) obj, path ? path : "", int(ascending));
+
+            if (!obj) {
+                return obj;
+            }
+
+            // the paths are resolved unlocked (they may lead back to the array), so the array is sorted
+            // only if nobody has changed it meanwhile, otherwise the sort starts over. Sorting under the lock
+            // could deadlock on such a path, so an array that keeps changing is left as it is
+            const int attempts = 8;
+            for (int i = 0; i < attempts; ++i) {
+                auto values = query::values_of(*obj);
+                auto order = query::sort_order(ctx, values, path, ascending);
+
+                object_lock g(obj);
+                if (query::u_holds(*obj, values)) {
+                    query::u_reorder(*obj, order);
+                    return obj;
+                }
+            }
+
+            JC_log("JArray.sortByPath: the array %p has been changed during %d sort attempts, left unsorted", (void*)obj, attempts);
+            return obj;
+        }
+        REGISTERF2(sortByPath, "* path ascending=true",
+            "Sorts the values by their @path values, keeps the order of equal ones. Numbers (ints and floats alike) are compared by value,\n"
+            "strings case-insensitively, different types are ordered none < number < form < object < string.\n"
+            "Returns the array itself. An array which other scripts keep changing meanwhile may be left unsorted. See filterByInt");
+
+#undef QUERY_COMMENT
+
         template<
             typename ValueType,
             typename TesValueType = reflection::binding::convert_to_tes_type<ValueType>,
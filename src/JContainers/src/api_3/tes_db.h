@@ -1,3 +1,5 @@
+#include <cstring>
+
 namespace tes_api_3 {
 
 /// Redefine in each logging module
@@ -17,11 +19,38 @@ namespace tes_api_3 {
 Manages keys and values associations (like JMap)";
         }
 
+        /// Looks the first element of the ".key<rest>" @path up in the snapshot of the JDB keys, so that the readers
+        /// don't lock the root. Calls @f(value, rest) with the null value for a missing key and returns what @f does.
+        /// Returns false if the @path doesn't start with a key
+        template<class F>
+        static bool with_top_level(tes_context& ctx, const char* path, F&& f) {
+            if (!path || path[0] != '.') {
+                return false;
+            }
+            const char* key = path + 1;
+            const char* rest = key + strcspn(key, ".[");
+            if (rest == key) {
+                return false;
+            }
+
+            auto keys = ctx.root_keys();
+            return f(keys->find(util::folded_key(std::string_view(key, rest - key))), rest);
+        }
+
         template<class T>
         static T solveGetter(tes_context& ctx, const char* path, T t= default_value<T>())
         {
             JC_LOG_API ("%s, ...", path ? path : "");
-            return tes_object::resolveGetter<T>(ctx, &ctx.root(), path, t);
+            bool solved = with_top_level(ctx, path, [&](const item* top, const char* rest) {
+                if (top && !*rest) {
+                    t = top->readAs<T>();
+                }
+                else if (top && top->object()) {
+                    t = tes_object::resolveGetter<T>(ctx, top->object(), rest, t);
+                }
+                return true; // a missing key or a non-object value with a path - nothing to resolve
+            });
+            return solved ? t : tes_object::resolveGetter<T>(ctx, &ctx.root(), path, t);
         }
         REGISTERF(solveGetter<Float32>, "solveFlt", "path default=0.0",
 "Attempts to retrieve the value associated with the @path.\n\
@@ -44,7 +73,16 @@ JDB.solveObj(\".frostfall.arrayC\") will return the array containing [\"stringVa
         static bool solveSetter(tes_context& ctx, const char* path, T value, bool createMissingKeys = false)
         {
             JC_LOG_API ("%s, ..., %d", path ? path : "", int (createMissingKeys));
-            return tes_object::solveSetter(ctx, &ctx.root(), path, value, createMissingKeys);
+            bool assigned = false;
+            // the values of the JDB itself and the missing keys are written under the root lock
+            bool inside_value = with_top_level(ctx, path, [&](const item* top, const char* rest) {
+                if (*rest && top && top->object()) {
+                    assigned = tes_object::solveSetter(ctx, top->object(), rest, value, createMissingKeys);
+                    return true;
+                }
+                return false;
+            });
+            return inside_value ? assigned : tes_object::solveSetter(ctx, &ctx.root(), path, value, createMissingKeys);
         }
         REGISTERF(solveSetter<Float32>, "solveFltSetter", "path value createMissingKeys=false",
             "Attempts to assign the @value. Returns false if no such path.\n"
@@ -75,7 +113,19 @@ for ex. JDB.setObj(\"frostfall\", frostFallInformation) will associate 'frostall
 
         static bool hasPath(tes_context& ctx, const char* path) {
             JC_LOG_API ("%s", path ? path : "");
-            return tes_object::hasPath(ctx, &ctx.root(), path);
+            bool found = false;
+            bool solved = with_top_level(ctx, path, [&](const item* top, const char* rest) {
+                if (!top || !*rest) {
+                    found = top != nullptr;
+                    return true;
+                }
+                if (top->object()) {
+                    found = tes_object::hasPath(ctx, top->object(), rest);
+                    return true;
+                }
+                return false;
+            });
+            return solved ? found : tes_object::hasPath(ctx, &ctx.root(), path);
         }
         REGISTERF2(hasPath, "path", "Returns true, if JDB capable resolve given @path, i.e. if it able to execute solve* or solver*Setter functions successfully");
 
@@ -105,4 +155,82 @@ for ex. JDB.setObj(\"frostfall\", frostFallInformation) will associate 'frostall
     };
 
     TES_META_INFO(tes_db);
+
+    TEST(tes_db, root_snapshot)
+    {
+        tes_context_standalone ctx;
+
+        object_stack_ref frostfall = tes_object::object<map>(ctx);
+        tes_db::setObj(ctx, "frostfall", frostfall);
+        EXPECT_TRUE(tes_db::solveSetter<SInt32>(ctx, ".frostfall.exposure", 5, true));
+        EXPECT_EQ(5, tes_db::solveGetter<SInt32>(ctx, ".FrostFall.exposure")); // JDB keys are case-insensitive
+        EXPECT_EQ(frostfall.get(), tes_db::solveGetter<object_base*>(ctx, ".frostfall"));
+        EXPECT_TRUE(tes_db::hasPath(ctx, ".frostfall.exposure"));
+        EXPECT_FALSE(tes_db::hasPath(ctx, ".frostfall.missing"));
+
+        // every way to write into the root is seen by the next read
+        EXPECT_TRUE(tes_db::solveSetter<SInt32>(ctx, ".counter", 1, true));
+        EXPECT_EQ(1, tes_db::solveGetter<SInt32>(ctx, ".counter"));
+        EXPECT_TRUE(tes_db::solveSetter<SInt32>(ctx, ".counter", 2));
+        EXPECT_EQ(2, tes_db::solveGetter<SInt32>(ctx, ".counter"));
+        tes_map::setItem<SInt32>(ctx, &ctx.root(), "counter", 3);
+        EXPECT_EQ(3, tes_db::solveGetter<SInt32>(ctx, ".counter"));
+        tes_atomic::performAtomicFunction<SInt32, std::plus<SInt32>>(ctx, &ctx.root(), ".counter", 1, 0, false, 0);
+        EXPECT_EQ(4, tes_db::solveGetter<SInt32>(ctx, ".counter"));
+        EXPECT_FALSE(tes_db::hasPath(ctx, ".counter.nested"));
+
+        // the path reads of the root itself keep the version
+        auto version = ctx.root_keys();
+        EXPECT_TRUE(tes_object::hasPath(ctx, &ctx.root(), ".counter"));
+        EXPECT_EQ(item_type::integer, tes_object::solvedValueType(ctx, &ctx.root(), ".counter"));
+        EXPECT_EQ(version, ctx.root_keys());
+
+        object_stack_ref other = tes_object::object<map>(ctx);
+        tes_db::setObj(ctx, "frostfall", other);
+        EXPECT_EQ(other.get(), tes_db::solveGetter<object_base*>(ctx, ".frostfall"));
+        EXPECT_EQ(-1, tes_db::solveGetter<SInt32>(ctx, ".frostfall.exposure", -1));
+
+        tes_map::removeKey(ctx, &ctx.root(), "counter");
+        EXPECT_FALSE(tes_db::hasPath(ctx, ".counter"));
+
+        map* replaced = tes_object::object<map>(ctx);
+        replaced->set("counter", item(10));
+        ctx.set_root(replaced);
+        EXPECT_EQ(10, tes_db::solveGetter<SInt32>(ctx, ".counter"));
+        EXPECT_FALSE(tes_db::hasPath(ctx, ".frostfall"));
+    }
+
+    TEST(tes_db, concurrent_solve_perft)
+    {
+        tes_context_standalone ctx;
+
+        for (int mod = 0; mod < 100; ++mod) {
+            tes_db::solveSetter<SInt32>(ctx, (".mod" + std::to_string(mod) + ".value").c_str(), mod, true);
+        }
+
+        std::vector<std::string> paths;
+        for (int mod = 0; mod < 100; ++mod) {
+            paths.push_back(".mod" + std::to_string(mod) + ".value");
+        }
+
+        const int readers = 4, reads = 250000;
+        std::atomic<int> matched{ 0 };
+        util::do_with_timing("JDB.solveInt, 4 threads x250000, 100 JDB keys", [&]() {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < readers; ++t) {
+                threads.emplace_back([&ctx, &paths, &matched]() {
+                    int own = 0;
+                    for (int i = 0; i < reads; ++i) {
+                        const int mod = i % 100;
+                        own += tes_db::solveGetter<SInt32>(ctx, paths[mod].c_str()) == mod;
+                    }
+                    matched += own;
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        });
+        EXPECT_EQ(readers * reads, matched.load());
+    }
 }
@@ -1,5 +1,4 @@
-#include "boost_extras.h"
-#include <boost/algorithm/string.hpp>
+#include <cstring>
 
 namespace tes_api_3 {
 
@@ -30,34 +29,27 @@ namespace tes_api_3 {
             char _storageName[bytesCount];
         public:
 
+            /// One pass over the @path, no allocations: the storage name is the part between the leading dot
+            /// and the next dot or bracket
             explicit subpath_extractor(const char * const path, path_type type = is_key) {
                 _storageName[0] = '\0';
                 _rest = nullptr;
 
-                if (!path) {
+                if (!path || path[0] != '.') {
                     return;
                 }
 
-                namespace bs = boost;
-
-                auto pathRange = bs::make_iterator_range(path, path + strlen(path));
-
-                auto pair1 = bs::half_split(pathRange, ".");
-
-                if (!pair1.first.empty() || pair1.second.empty()) {
+                const char *name = path + 1;
+                const char *separator = name + strcspn(name, ".[");
+                if (separator == name || !separator[0] || !separator[1]) {
                     return;
                 }
 
-                auto pair2 = bs::half_split_if(pair1.second, bs::is_any_of(".["));
+                auto storageNameLen = std::min<size_t>(bytesCount - 1, separator - name);
+                std::copy_n(name, storageNameLen, _storageName);
+                _storageName[storageNameLen] = '\0';
 
-                if (!pair2.first.empty() && !pair2.second.empty()) {
-                    auto strorageNameLen = std::min<size_t>(bytesCount-1,  pair2.first.size());
-                    std::copy_n(pair2.first.begin(), strorageNameLen, _storageName);
-                    _storageName[strorageNameLen] = '\0';
-
-                    _rest = (type == is_key ?
-                        pair2.second.begin() : pair2.second.begin() - 1);
-                }
+                _rest = (type == is_key ? separator + 1 : separator);
             }
 
             const char *rest() const {
@@ -76,8 +68,7 @@ namespace tes_api_3 {
                 return nullptr;
             }
 
-            auto& db = ctx.root();
-            form_map::ref fmap = tes_map::getItem<object_base*>(ctx, &db, storageName)->as<form_map>();
+            form_map::ref fmap = ctx.form_storage(storageName);
 
             if (!fmap) {
                 fmap = tes_object::object<form_map>(ctx);
@@ -103,9 +94,7 @@ namespace tes_api_3 {
                 auto fmap = makeFormStorage(ctx, storageName);
                 tes_form_map::setItem(ctx, fmap, formKey, entry);
             } else {
-                auto& db = ctx.root();
-                auto fmap = tes_map::getItem<object_base*>(ctx, &db, storageName)->as<form_map>();
-                tes_form_map::removeKey(ctx, fmap, formKey);
+                tes_form_map::removeKey(ctx, ctx.form_storage(storageName).get(), formKey);
             }
         }
         REGISTERF2(setEntry, "storageName fKey entry", "associates given form key and entry (container). set entry to zero to destroy association");
@@ -133,9 +122,7 @@ namespace tes_api_3 {
         {
             JC_LOG_API ("%s, ...", storageName ? storageName : "");
 
-            auto& db = ctx.root();
-            form_map *fmap = tes_map::getItem<object_base*>(ctx, &db, storageName)->as<form_map>();
-            return tes_form_map::getItem<object_base*>(ctx, fmap, form);
+            return tes_form_map::getItem<object_base*>(ctx, ctx.form_storage(storageName).get(), form);
         }
         REGISTERF2(findEntry, "storageName fKey", "search for entry for given storage and form");
 
@@ -143,6 +130,57 @@ namespace tes_api_3 {
             return findEntry(ctx, storageName, form)->as<map>();
         }
 
+        // the storages (the JFormMaps of the JDB) having an entry of the @form, with their names
+        static std::vector<std::pair<item, form_map::ref>> storagesWith(tes_context& ctx, FormId form) {
+            std::vector<std::pair<item, form_map::ref>> storages;
+            if (form == FormId::Zero) {
+                return storages;
+            }
+
+            auto maps = ctx.form_maps_with(form);
+            if (maps.empty()) {
+                return storages;
+            }
+
+            auto& db = ctx.root();
+            object_read_lock g(db);
+            for (auto& pair : db.u_container()) {
+                auto fmap = pair.second.object() ? pair.second.object()->as<form_map>() : nullptr;
+                auto is_fmap = [fmap](const form_map::ref& found) { return found.get() == fmap; };
+                if (fmap && std::any_of(maps.begin(), maps.end(), is_fmap)) {
+                    storages.emplace_back(item(pair.first), fmap);
+                }
+            }
+            return storages;
+        }
+
+        static object_base* storagesOf(tes_context& ctx, key_cref form)
+        {
+            JC_LOG_API ("...");
+
+            auto storages = storagesWith(ctx, form.get());
+            return &array::objectWithInitializer([&](array& arr) {
+                for (auto& storage : storages) {
+                    arr.u_push(std::move(storage.first));
+                }
+            },
+                ctx);
+        }
+        REGISTERF2(storagesOf, "fKey", "returns new array containing the names of the storages which have an entry for given form");
+
+        static SInt32 eraseEntries(tes_context& ctx, key_cref form)
+        {
+            JC_LOG_API ("...");
+
+            SInt32 erased = 0;
+            for (auto& storage : storagesWith(ctx, form.get())) {
+                object_lock g(storage.second);
+                erased += storage.second->u_erase_form(form.get()) ? 1 : 0;
+            }
+            return erased;
+        }
+        REGISTERF2(eraseEntries, "fKey", "removes the entries of given form from all storages. Returns the number of storages the form was removed from");
+
         //////////////////////////////////////////////////////////////////////////
 
         template<class T>
@@ -275,6 +313,112 @@ namespace tes_api_3 {
     }
 
 
+    TEST(tes_form_db, storages_of_form)
+    {
+        tes_context_standalone ctx;
+
+        auto form = make_lightweight_form_ref((FormId)0x14, ctx);
+        auto other = make_lightweight_form_ref((FormId)0x15, ctx);
+
+        tes_form_db::makeMapEntry(ctx, "first", form);
+        tes_form_db::makeMapEntry(ctx, "first", other);
+        tes_form_db::makeMapEntry(ctx, "second", other);
+        EXPECT_EQ(0, tes_array::count(ctx, tes_form_db::storagesOf(ctx, make_lightweight_form_ref((FormId)0x16, ctx))));
+
+        // the index is on now, the new keys get indexed as they're added
+        tes_form_db::makeMapEntry(ctx, "second", form);
+        object_stack_ref copy = tes_object::shallowCopy(ctx, tes_form_db::makeFormStorage(ctx, "second"));
+        tes_db::setObj(ctx, "third", copy);
+
+        auto storages = tes_form_db::storagesOf(ctx, form)->as<array>();
+        EXPECT_EQ(3, tes_array::count(ctx, storages));
+        EXPECT_NE(-1, tes_array::findVal<const char*>(ctx, storages, "third"));
+
+        {
+            // the pass indexing the maps which existed before the index was on may reach a map which reported its keys
+            object_lock g(copy);
+            copy->as<form_map>()->u_index_keys();
+        }
+        tes_form_map::removeKey(ctx, copy->as<form_map>(), form);
+        EXPECT_EQ(2, tes_array::count(ctx, tes_form_db::storagesOf(ctx, form)));
+
+        EXPECT_EQ(2, tes_form_db::eraseEntries(ctx, form));
+        EXPECT_EQ(0, tes_array::count(ctx, tes_form_db::storagesOf(ctx, form)));
+        EXPECT_EQ(3, tes_array::count(ctx, tes_form_db::storagesOf(ctx, other)));
+        EXPECT_TRUE(tes_form_db::findEntry(ctx, "first", other) != nullptr);
+    }
+
+    TEST(tes_form_db, storages_of_form_perft)
+    {
+        tes_context_standalone ctx;
+
+        for (int storage = 0; storage < 20; ++storage) {
+            const std::string name = "storage" + std::to_string(storage);
+            for (uint32_t i = 0; i < 20000; ++i) {
+                tes_form_db::setItem<SInt32>(ctx, make_lightweight_form_ref((FormId)(0xff000000 | i), ctx), ("." + name + ".value").c_str(), 1);
+            }
+        }
+
+        util::do_with_timing("JFormDB.storagesOf, 20 storages of 20000 forms", [&]() {
+            for (uint32_t i = 0; i < 20000; ++i) {
+                EXPECT_EQ(20, tes_array::count(ctx, tes_form_db::storagesOf(ctx, make_lightweight_form_ref((FormId)(0xff000000 | i), ctx))));
+            }
+        });
+    }
+
+    TEST(tes_form_db, storage_cache)
+    {
+        tes_context_standalone ctx;
+
+        auto form = make_lightweight_form_ref((FormId)0x14, ctx);
+        form_map* storage = tes_form_db::makeFormStorage(ctx, "Cached");
+        EXPECT_EQ(storage, ctx.form_storage("cached").get());   // JDB keys are case-insensitive
+        EXPECT_EQ(storage, ctx.form_storage("CACHED").get());
+
+        // a new value under the same key
+        object_stack_ref other = tes_object::object<form_map>(ctx);
+        tes_db::setObj(ctx, "cached", other);
+        EXPECT_EQ(other.get(), ctx.form_storage("cached").get());
+
+        object_stack_ref none;
+        tes_db::setObj(ctx, "cached", none);
+        EXPECT_EQ(nullptr, ctx.form_storage("cached").get());
+        EXPECT_EQ(nullptr, tes_form_db::findEntry(ctx, "cached", form));
+
+        map* entry = tes_form_db::makeMapEntry(ctx, "cached", form);
+        EXPECT_EQ(entry, tes_form_db::findEntry(ctx, "cached", form));
+
+        tes_map::clear(ctx, &ctx.root());
+        EXPECT_EQ(nullptr, ctx.form_storage("cached").get());
+
+        map* replaced = tes_object::object<map>(ctx);
+        ctx.set_root(replaced);
+        EXPECT_EQ(nullptr, ctx.form_storage("cached").get());
+    }
+
+    TEST(tes_form_db, solveInt_perft)
+    {
+        tes_context_standalone ctx;
+
+        for (int storage = 0; storage < 300; ++storage) {
+            tes_db::solveSetter<SInt32>(ctx, (".mod" + std::to_string(storage) + ".value").c_str(), storage, true);
+        }
+        std::vector<form_ref_lightweight> forms;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            forms.push_back(make_lightweight_form_ref((FormId)(0xff000000 | i), ctx));
+            tes_form_db::solveSetter<SInt32>(ctx, forms.back(), ".mymod.hp", (SInt32)i, true);
+        }
+
+        SInt32 matched = 0;
+        util::do_with_timing("JFormDB.solveInt(form, \".mymod.hp\"), 300 JDB keys, x1000000", [&]() {
+            for (int i = 0; i < 1000000; ++i) {
+                const SInt32 idx = i % (SInt32)forms.size();
+                matched += tes_form_db::solveGetter<SInt32>(ctx, forms[idx], ".mymod.hp") == idx;
+            }
+        });
+        EXPECT_EQ(1000000, matched);
+    }
+
     TEST(tes_form_db, get_set)
     {
         tes_context_standalone ctx;
@@ -1,3 +1,6 @@
+#include "collections/census.h"
+#include "domains/domain_master.h"
+
 namespace tes_api_3 {
 
 /// Redefine in each logging module
@@ -128,6 +131,113 @@ namespace tes_api_3 {
         }
         REGISTERF_STATELESS(_userDirectory, "userDirectory", "", "A path to user-specific directory - " JC_USER_FILES);
 
+        static object_base* lastSaveLoadReport(tes_context& ctx, const char* operation = "load")
+        {
+            JC_LOG_API ("%s", operation ? operation : "");
+
+            auto json = util::profiling::report::last_as_json(operation && *operation ? operation : "load");
+            return json.empty() ? nullptr : json_deserializer::object_from_json_data(ctx, json.c_str());
+        }
+        REGISTERF2(lastSaveLoadReport, "operation=\"load\"",
+            "Returns a profiling report of the last save or load (@operation is \"save\" or \"load\") or None.\n"
+            "The report is a JMap with the total seconds and bytes, the timed phases (clearing the state, header, registry, aqueue,\n"
+            "form observer, deleting inactive domains, post-load initializations, updates, garbage collection; expired forms removal\n"
+            "on save), and the bytes spent per domain and per collection type.\n"
+            "The same report is written into the SKSE logs folder as " JC_PLUGIN_NAME "_save.json and " JC_PLUGIN_NAME "_load.json");
+
+        static object_base* luaContextPoolStats(tes_context& ctx)
+        {
+            JC_LOG_API ("");
+
+            auto stats = lua::context_pool_stats(ctx);
+            auto& obj = map::object(ctx);
+            obj.set("created", (SInt32)stats.created);
+            obj.set("threadHits", (SInt32)stats.thread_hits);
+            obj.set("poolHits", (SInt32)stats.pool_hits);
+            obj.set("waits", (SInt32)stats.waits);
+            obj.set("overLimit", (SInt32)stats.over_limit);
+            obj.set("peakConcurrency", (SInt32)stats.peak_concurrency);
+            obj.set("peakContexts", (SInt32)stats.peak_contexts);
+            obj.set("contexts", (SInt32)stats.contexts);
+            obj.set("maxContexts", (SInt32)stats.max_contexts);
+            return &obj;
+        }
+        REGISTERF2(luaContextPoolStats, "",
+            "Returns a JMap with the JLua context pool counters: created contexts, reuses of a thread's own context (threadHits),\n"
+            "reuses of an idle shared one (poolHits), waits for a free context, contexts created above the limit (overLimit),\n"
+            "max. contexts in use at once (peakConcurrency), max. contexts alive (peakContexts), alive contexts and the limit");
+
+        static void setLuaContextPoolLimits(tes_context& ctx, SInt32 maxContexts = JC_LUA_MAX_CONTEXTS, SInt32 waitMilliseconds = JC_LUA_CONTEXT_WAIT_MS,
+            SInt32 prewarmedContexts = JC_LUA_PREWARMED_CONTEXTS)
+        {
+            JC_LOG_API ("%d, %d, %d", maxContexts, waitMilliseconds, prewarmedContexts);
+
+            lua::set_context_pool_limits(ctx, lua::pool_limits{
+                (uint32_t)(std::max)(maxContexts, 1),
+                (uint32_t)(std::max)(waitMilliseconds, 0)
+            });
+            lua::prewarm_contexts(ctx, (uint32_t)(std::max)(prewarmedContexts, 0));
+        }
+        REGISTERF2(setLuaContextPoolLimits, "maxContexts=" STR(JC_LUA_MAX_CONTEXTS) " waitMilliseconds=" STR(JC_LUA_CONTEXT_WAIT_MS)
+            " prewarmedContexts=" STR(JC_LUA_PREWARMED_CONTEXTS),
+            "Limits the number of Lua contexts JLua keeps. Once @maxContexts exist, a script waits up to @waitMilliseconds\n"
+            "for a free context, then creates one more that is destroyed after the use.\n"
+            "@prewarmedContexts idle contexts (at most @maxContexts) are kept ready, created in the background now and after each game load.\n"
+            "The settings are per domain: the calling script's one");
+
+        static object_base* apiCallStats(tes_context& ctx, bool reset = false)
+        {
+            JC_LOG_API ("%d", reset);
+
+            auto json = util::call_stats::snapshot_as_json();
+            if (reset) {
+                util::call_stats::reset();
+            }
+            return json_deserializer::object_from_json_data(ctx, json.c_str());
+        }
+        REGISTERF2(apiCallStats, "reset=false",
+            "Returns a JMap with the counters of the JContainers calls made since the game started or the last reset: total calls and seconds,\n"
+            "and the functions array, the most time-consuming first. Each function has its name, calls, seconds, averageMicroseconds\n"
+            "and log2NanosecondsHistogram, where the element i counts the calls that took 2^i to 2^(i+1) nanoseconds.\n"
+            "If @reset is true, the counting starts from zero again");
+
+        static bool writeAPICallStats(const char* path, bool reset = false)
+        {
+            JC_LOG_API ("%s, %d", path ? path : "", reset);
+
+            bool written = util::call_stats::write_snapshot_to_file(path);
+            if (reset) {
+                util::call_stats::reset();
+            }
+            return written;
+        }
+        REGISTERF2_STATELESS(writeAPICallStats, "path reset=false",
+            "Writes the same counters as apiCallStats returns into the JSON file at the @path, without creating any JContainers objects");
+
+        static bool writeMemoryCensus(const char* path)
+        {
+            JC_LOG_API ("%s", path ? path : "");
+
+            if (!path) {
+                return false;
+            }
+
+            auto& master = domain_master::master::instance();
+            json_t* domains = json_object();
+            json_object_set_new(domains, "<default>", census::to_json(census::take(master.get_default_domain())));
+            for (auto& pair : master.active_domains_map()) {
+                json_object_set_new(domains, pair.first.c_str(), census::to_json(census::take(*pair.second)));
+            }
+
+            auto js = make_unique_ptr(json_object(), &json_decref);
+            json_object_set_new(js.get(), "domains", domains);
+            return json_dump_file(js.get(), path, JSON_INDENT(2)) == 0;
+        }
+        REGISTERF2_STATELESS(writeMemoryCensus, "path",
+            "Writes into the JSON file at the @path who holds the JContainers objects, for each domain: the number of objects, items,\n"
+            "string bytes and forms in total, per collection type, per tag (see JValue.retain) and per JDB key.\n"
+            "An object belongs to the first JDB key it can be reached from, JFormDB storages are JDB keys too");
+
         REGISTER_TEXT([]() {
             const char fmt[] = R"===(
 ; Returns true if JContainers plugin installed properly
@@ -174,6 +284,90 @@ endfunction
         write_file("\\path4\\obj3");
     }
 
+    TEST(tes_jcontainers, lastSaveLoadReport)
+    {
+        tes_context_standalone ctx;
+
+        std::stringstream stream;
+        {
+            util::profiling::counting_streambuf counter{ stream.rdbuf() };
+            util::profiling::report report{ "save" };
+            util::profiling::report::attach attached{ report, counter };
+            util::profiling::phase_scope p{ "phase" };
+        }
+
+        object_stack_ref obj = tes_jcontainers::lastSaveLoadReport(ctx, "save");
+        EXPECT_TRUE(obj && obj->as<map>());
+        EXPECT_TRUE(tes_jcontainers::lastSaveLoadReport(ctx, "unknown operation") == nullptr);
+    }
+
+    TEST(tes_jcontainers, apiCallStats)
+    {
+        tes_context_standalone ctx;
+
+        const uint32_t fast = util::call_stats::register_function("JTest", "fast");
+        const uint32_t slow = util::call_stats::register_function("JTest", "slow");
+        ASSERT_TRUE(fast != 0 && slow != 0);
+
+        util::call_stats::reset();
+        util::call_stats::record(fast, 100);
+        util::call_stats::record(fast, 3);
+        std::thread([slow]() { util::call_stats::record(slow, 5000); }).join();    // an exited thread still counts
+
+        object_stack_ref obj = tes_jcontainers::apiCallStats(ctx, true);
+        ASSERT_TRUE(obj && obj->as<map>());
+        EXPECT_EQ(3, tes_object::resolveGetter<SInt32>(ctx, obj.get(), ".calls"));
+        map* slowest = tes_object::resolveGetter<object_base*>(ctx, obj.get(), ".functions[0]")->as<map>();
+        ASSERT_TRUE(slowest != nullptr);
+        EXPECT_STREQ("JTest.slow", slowest->u_get("name")->strValue());
+        EXPECT_EQ(2, tes_object::resolveGetter<SInt32>(ctx, obj.get(), ".functions[1].calls"));
+        // 3ns and 100ns, in the buckets 1 and 6
+        object_base* histogram = tes_object::resolveGetter<object_base*>(ctx, obj.get(), ".functions[1].log2NanosecondsHistogram");
+        EXPECT_EQ(7, tes_object::count(ctx, histogram));
+        EXPECT_EQ(1, tes_object::resolveGetter<SInt32>(ctx, obj.get(), ".functions[1].log2NanosecondsHistogram[1]"));
+        EXPECT_EQ(1, tes_object::resolveGetter<SInt32>(ctx, obj.get(), ".functions[1].log2NanosecondsHistogram[6]"));
+
+        EXPECT_TRUE(util::call_stats::snapshot().empty());
+    }
+
+    JC_TEST(census, ownership)
+    {
+        map& modA = map::object(context);
+        modA.u_set("name", item("hello"));
+        array& list = array::object(context);
+        list.u_push(item(1));
+        list.u_push(item(2));
+        modA.u_set("list", item(list));
+
+        array& modB = array::object(context);
+        for (int i = 0; i < 3; ++i) {
+            modB.u_push(item("ab"));
+        }
+        modB.u_push(item(list)); // reached from modA first
+
+        map& root = context.root();
+        root.u_set("modA", item(modA));
+        root.u_set("modB", item(modB));
+
+        object_stack_ref tagged = tes_object::object<map>(context);
+        tes_object::retain(context, tagged.get(), "myTag");
+
+        auto report = census::take(context);
+        EXPECT_EQ(5u, report.total.objects);
+        EXPECT_EQ(3u, report.types["JMap"].objects);
+        EXPECT_EQ(2u, report.types["JArray"].objects);
+        EXPECT_EQ(1u, report.tags["myTag"].objects);
+        EXPECT_EQ(4u, report.tags[census::untagged].objects);
+
+        EXPECT_EQ(2u, report.jdb_keys["modA"].objects);
+        EXPECT_EQ(4u, report.jdb_keys["modA"].items);
+        EXPECT_EQ(4u + 4 + 5, report.jdb_keys["modA"].string_bytes);
+        EXPECT_EQ(1u, report.jdb_keys["modB"].objects);
+        EXPECT_EQ(3u * 2, report.jdb_keys["modB"].string_bytes);
+        EXPECT_EQ(1u, report.jdb_keys[census::root_key].objects);
+        EXPECT_EQ(1u, report.jdb_keys[census::no_key].objects);
+    }
+
     TEST(tes_jcontainers, contentsOfDirectoryAtPath)
     {
         std::vector<std::string> vec;
@@ -34,11 +34,11 @@ namespace tes_api_3 {
             map_functions::doReadOp(obj, key, [&](item& itm) { def = itm.readAs<T>(); });
             return def;
         }
-        REGISTERF(getItem<SInt32>, "getInt", "object key default=0", "Returns the value associated with the @key. If not, returns @default value");
-        REGISTERF(getItem<Float32>, "getFlt", "object key default=0.0", "");
-        REGISTERF(getItem<skse::string_ref>, "getStr", "object key default=\"\"", "");
-        REGISTERF(getItem<object_base*>, "getObj", "object key default=0", "");
-        REGISTERF(getItem<form_ref>, "getForm", "object key default=None", "");
+        REGISTERF_BORROWED(getItem<SInt32>, "getInt", "object key default=0", "Returns the value associated with the @key. If not, returns @default value");
+        REGISTERF_BORROWED(getItem<Float32>, "getFlt", "object key default=0.0", "");
+        REGISTERF_BORROWED(getItem<skse::string_ref>, "getStr", "object key default=\"\"", "");
+        REGISTERF_BORROWED(getItem<object_base*>, "getObj", "object key default=0", "");
+        REGISTERF_BORROWED(getItem<form_ref>, "getForm", "object key default=None", "");
 
         template<class T>
         static void setItem(tes_context& ctx, ref obj, key_cref key, T val) {
@@ -77,7 +77,7 @@ namespace tes_api_3 {
             JC_LOG_API ("%p, ...", (void*) obj);
             return valueType(ctx, obj, key) != 0;
         }
-        REGISTERF2(hasKey, "* key", "Returns true, if the container has @key: value pair");
+        REGISTERF2_BORROWED(hasKey, "* key", "Returns true, if the container has @key: value pair");
 
         static SInt32 valueType(tes_context& ctx, ref obj, key_cref key) {
             JC_LOG_API ("%p, ...", (void*) obj);
@@ -85,7 +85,7 @@ namespace tes_api_3 {
             map_functions::doReadOp(obj, key, [&](item& itm) { type = itm.type(); });
             return (SInt32)type;
         }
-        REGISTERF2(valueType, "* key", "Returns type of the value associated with the @key.\n"VALUE_TYPE_COMMENT);
+        REGISTERF2_BORROWED(valueType, "* key", "Returns type of the value associated with the @key.\n"VALUE_TYPE_COMMENT);
 
         static object_base* allKeys(tes_context& ctx, ref obj)
         {
@@ -96,9 +96,9 @@ namespace tes_api_3 {
             }
 
             return &array::objectWithInitializer([&](array &arr) {
-                object_lock g(obj);
+                object_read_lock g(obj);
 
-                arr._array.reserve(obj->u_count());
+                arr.u_container().reserve(obj->u_count());
                 for each(auto& pair in obj->u_container()) {
                     arr.u_container().emplace_back(pair.first);
                 }
@@ -116,7 +116,7 @@ namespace tes_api_3 {
             }
 
             VMResultArray<tes_key> keys;
-            object_lock l(obj);
+            object_read_lock l(obj);
             keys.reserve(obj->u_count());
             std::transform(obj->u_container().begin(), obj->u_container().end(),
                 std::back_inserter(keys),
@@ -138,11 +138,11 @@ namespace tes_api_3 {
             }
 
             return &array::objectWithInitializer([&](array &arr) {
-                object_lock g(obj);
+                object_read_lock g(obj);
 
-                arr._array.reserve(obj->u_count());
+                arr.u_container().reserve(obj->u_count());
                 for each(auto& pair in obj->u_container()) {
-                    arr._array.push_back(pair.second);
+                    arr.u_container().push_back(pair.second);
                 }
             },
                 ctx);
@@ -170,7 +170,7 @@ namespace tes_api_3 {
 
             return obj->s_count();
         }
-        REGISTERF2(count, "*", "Returns count of pairs in the conainer");
+        REGISTERF2_BORROWED(count, "*", "Returns count of pairs in the conainer");
 
         static void clear(tes_context& ctx, ref obj)
         {
@@ -192,16 +192,15 @@ namespace tes_api_3 {
                 return;
             }
 
-            object_lock g(obj);
-            object_lock c(source);
+            object_lock_pair g(*obj, *source);
 
-            if (overrideDuplicates) {
-                for (const auto& pair : source->u_container()) {
-                    obj->u_container()[pair.first] = pair.second;
+            for (const auto& pair : source->u_container()) {
+                if (overrideDuplicates) {
+                    obj->u_get_or_create(pair.first) = pair.second;
+                }
+                else {
+                    obj->u_insert(pair);
                 }
-            }
-            else {
-                obj->u_container().insert(source->u_container().begin(), source->u_container().end());
             }
         }
         REGISTERF2(addPairs, "* source overrideDuplicates", "Inserts key-value pairs from the source container");
@@ -269,7 +268,7 @@ Usage:
             map_functions::nextKey(obj, previousKey, [&](const std::string& key) { str = key.c_str(); });
             return str;
         }
-        REGISTERF(nextKey<skse::string_ref>, "nextKey", STR(* previousKey="" endKey=""), tes_map_nextKey_comment);
+        REGISTERF_BORROWED(nextKey<skse::string_ref>, "nextKey", STR(* previousKey="" endKey=""), tes_map_nextKey_comment);
 
         static const char * getNthKey_comment() { return "Retrieves N-th key. " NEGATIVE_IDX_COMMENT "\nWorst complexity is O(n/2)"; }
 
@@ -279,13 +278,38 @@ Usage:
             map_functions::getNthKey(obj, keyIndex, [&](const std::string& key) { ith = key.c_str(); });
             return ith;
         }
-        REGISTERF(getNthKey<skse::string_ref>, "getNthKey", "* keyIndex", getNthKey_comment());
+        REGISTERF_BORROWED(getNthKey<skse::string_ref>, "getNthKey", "* keyIndex", getNthKey_comment());
+
+        static object_base* groupBy(tes_context& ctx, object_base* collection, const char* path) {
+            JC_LOG_API ("%p, %s", (void*) collection, path ? path : "");
+
+            if (!collection) {
+                return nullptr;
+            }
+
+            auto values = query::values_of(*collection);
+            auto groups = query::group_by(ctx, values, path);
+            return &map::objectWithInitializer([&](map& me) {
+                for (auto& group : groups) {
+                    auto& grouped = array::objectWithInitializer([&](array& arr) {
+                        arr.u_container() = std::move(group.second);
+                    },
+                        ctx);
+                    me.u_get_or_create(group.first.c_str()) = item(grouped);
+                }
+            },
+                ctx);
+        }
+        REGISTERF2(groupBy, "collection path",
+            "Groups the values of the @collection (any container) by their @path value. Returns a new JMap where each key is\n"
+            "a @path value (a string or a number) and the value is an array of the values that have it, in their original order.\n"
+            "Values whose @path value is neither a string nor a number are left out. See JArray.filterByInt for the @path syntax");
     };
 
     struct tes_form_map_ext : class_meta < tes_form_map_ext > {
         REGISTER_TES_NAME("JFormMap");
-        REGISTERF(tes_form_map_ext::nextKey, "nextKey", STR(* previousKey=None endKey=None), tes_map_nextKey_comment);
-        REGISTERF(tes_form_map::getNthKey, "getNthKey", "* keyIndex", tes_map_ext::getNthKey_comment());
+        REGISTERF_BORROWED(tes_form_map_ext::nextKey, "nextKey", STR(* previousKey=None endKey=None), tes_map_nextKey_comment);
+        REGISTERF_BORROWED(tes_form_map::getNthKey, "getNthKey", "* keyIndex", tes_map_ext::getNthKey_comment());
 
         struct KeyCompareForNextKey {
             template<class K1, class K2>
@@ -306,8 +330,8 @@ Usage:
 
     struct tes_integer_map_ext : class_meta < tes_integer_map_ext > {
         REGISTER_TES_NAME("JIntMap");
-        REGISTERF(tes_integer_map::nextKey, "nextKey", STR(* previousKey=0 endKey=0), tes_map_nextKey_comment);
-        REGISTERF(tes_integer_map::getNthKey, "getNthKey", "* keyIndex", tes_map_ext::getNthKey_comment());
+        REGISTERF_BORROWED(tes_integer_map::nextKey, "nextKey", STR(* previousKey=0 endKey=0), tes_map_nextKey_comment);
+        REGISTERF_BORROWED(tes_integer_map::getNthKey, "getNthKey", "* keyIndex", tes_map_ext::getNthKey_comment());
     };
 
     TES_META_INFO(tes_map_ext);
@@ -343,4 +367,29 @@ Usage:
         EXPECT_EQ(countIterations(fmap), 2);
     }
 
+    JC_TEST(tes_map, getInt_perft)
+    {
+        for (int keyCount : { 10, 100, 1000, 10000 }) {
+            map* m = tes_object::object<map>(context);
+            std::vector<std::string> keys;
+            for (int i = 0; i < keyCount; ++i) {
+                keys.push_back("SomeKey_" + std::to_string(i));
+                m->u_set(keys.back(), i);
+            }
+            // look the keys up with a different case
+            for (auto& key : keys) {
+                util::case_fold::fold(key);
+            }
+
+            std::string name = "JMap.getInt, " + std::to_string(keyCount) + " keys";
+            SInt32 sum = 0;
+            util::do_with_timing(name.c_str(), [&]() {
+                for (int i = 0; i < 1000000; ++i) {
+                    sum += tes_map::getItem<SInt32>(context, m, keys[i % keyCount].c_str());
+                }
+            });
+            EXPECT_TRUE(sum > 0);
+        }
+    }
+
 }
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "util/numeric_kernels.h"
+
+namespace tes_api_3 {
+
+/// Redefine in each logging module
+#undef  JC_LOG_API_SOURCE
+#define JC_LOG_API_SOURCE "JNumericArray"
+
+    using namespace collections;
+
+    /// JIntArray and JFltArray: JArrays with the numbers packed into a plain vector.
+    /// Any JArray function still works on them, a value of another type unpacks the array for good
+    template<class T, class Packed, array::layout Layout>
+    class tes_numeric_array_t : public class_meta< tes_numeric_array_t<T, Packed, Layout> >, public collections::array_functions {
+    public:
+
+        typedef array* ref;
+        typedef std::vector<Packed> values_type;
+
+        void additionalSetup() {
+            metaInfo._className = Layout == array::layout::ints ? "JIntArray" : "JFltArray";
+            metaInfo.comment = Layout == array::layout::ints
+                ? "Array of integers, stored packed. Inherits JArray functionality"
+                : "Array of floats, stored packed. Inherits JArray functionality";
+        }
+
+        static values_type* values(array& obj) { return values(obj, (Packed*)nullptr); }
+        static array::ints_type* values(array& obj, int32_t*) { return obj.u_ints(); }
+        static array::floats_type* values(array& obj, float*) { return obj.u_floats(); }
+
+        static object_base* object(tes_context& ctx) {
+            JC_LOG_API ("");
+            return &array::objectWithInitializer([](array& me) {
+                me.u_set_layout(Layout);
+            },
+                ctx);
+        }
+        REGISTERF2(object, "", kCommentObject);
+
+        static object_base* objectWithSize(tes_context& ctx, SInt32 size) {
+            JC_LOG_API ("%d", size);
+
+            if (size < 0) {
+                return nullptr;
+            }
+
+            return &array::objectWithInitializer([&](array& me) {
+                me.u_set_layout(Layout);
+                values(me)->resize(size);
+            },
+                ctx);
+        }
+        REGISTERF2(objectWithSize, "size", "Creates a new array of given size, filled with zeros");
+
+        static object_base* objectWithValues(tes_context& ctx, VMArray<T> arr) {
+            JC_LOG_API ("...");
+
+            return &array::objectWithInitializer([&](array& me) {
+                me.u_set_layout(Layout);
+                auto& vals = *values(me);
+                vals.resize(arr.Length());
+                for (UInt32 i = 0; i < arr.Length(); ++i) {
+                    T val;
+                    arr.Get(&val, i);
+                    vals[i] = (Packed)val;
+                }
+            },
+                ctx);
+        }
+        REGISTERF2(objectWithValues, "values", "Creates a new array that contains given values");
+
+        static T get(tes_context& ctx, ref obj, SInt32 index, T def = T(0)) {
+            JC_LOG_API ("%p, %d, ...", (void*) obj, index);
+
+            doReadOp(obj, index, [=, &def](uint32_t idx) {
+                if (auto vals = values(*obj)) {
+                    def = (T)(*vals)[idx];
+                }
+                else {
+                    obj->u_read_at(idx, [&def](const item& itm) { def = itm.readAs<T>(); });
+                }
+            });
+            return def;
+        }
+        REGISTERF2_BORROWED(get, "* index default=0", "Returns the value at the index of the array.\n" NEGATIVE_IDX_COMMENT);
+
+        static void set(tes_context& ctx, ref obj, SInt32 index, T value) {
+            tes_array::replaceItemAtIndex<T>(ctx, obj, index, value);
+        }
+        REGISTERF2(set, "* index value", "Replaces existing value at the @index of the array with the new @value.\n" NEGATIVE_IDX_COMMENT);
+
+        static void add(tes_context& ctx, ref obj, T value, SInt32 addToIndex = -1) {
+            tes_array::addItemAt<T>(ctx, obj, value, addToIndex);
+        }
+        REGISTERF2(add, "* value addToIndex=-1", "Appends the @value to the end of the array.\n\
+If @addToIndex >= 0 it inserts value at given index. " NEGATIVE_IDX_COMMENT);
+
+        static SInt32 find(tes_context& ctx, ref obj, T value, SInt32 searchStartIndex = 0) {
+            return tes_array::findVal<T>(ctx, obj, value, searchStartIndex);
+        }
+        REGISTERF2_BORROWED(find, "* value searchStartIndex=0",
+"Returns the index of the first found value or -1.\n\
+@searchStartIndex - index of the array where to start search. Negative index searches backwards");
+
+        static SInt32 countValue(tes_context& ctx, ref obj, T value) {
+            return tes_array::count_item<T>(ctx, obj, value);
+        }
+        REGISTERF2_BORROWED(countValue, "* value", "Returns the number of times given value was found in the array");
+
+        static SInt32 eraseValue(tes_context& ctx, ref obj, T value) {
+            return tes_array::erase_item<T>(ctx, obj, value);
+        }
+        REGISTERF2(eraseValue, "* value", "Erases all elements of given value. Returns the number of erased elements");
+
+        static ref sort(tes_context& ctx, ref obj) {
+            JC_LOG_API ("%p", (void*) obj);
+
+            if (!obj) {
+                return obj;
+            }
+
+            {
+                object_lock g(obj);
+                if (auto vals = values(*obj)) {
+                    std::sort(vals->begin(), vals->end());
+                    return obj;
+                }
+            }
+            return tes_array::sort(ctx, obj);
+        }
+        REGISTERF2(sort, "*", "Sorts the values into ascending order. Returns the array itself");
+
+        enum class aggregate { sum, min, max };
+
+        template<aggregate Op>
+        static T aggregate_values(tes_context& ctx, ref obj) {
+            JC_LOG_API ("%p", (void*) obj);
+
+            if (!obj) {
+                return T(0);
+            }
+
+            object_lock g(obj);
+            values_type numbers;
+            auto vals = values(*obj);
+            if (!vals) {
+                // unpacked: aggregates the numbers, skips anything else
+                for (auto& itm : obj->u_container()) {
+                    if (itm.isNumber()) {
+                        numbers.push_back((Packed)itm.readAs<T>());
+                    }
+                }
+                vals = &numbers;
+            }
+
+            if (vals->empty()) {
+                return T(0);
+            }
+
+            switch (Op) {
+            case aggregate::min:
+                return (T)util::numeric::min(vals->data(), vals->size());
+            case aggregate::max:
+                return (T)util::numeric::max(vals->data(), vals->size());
+            default:
+                return (T)util::numeric::sum(vals->data(), vals->size());
+            }
+        }
+        REGISTERF_BORROWED(aggregate_values<aggregate::sum>, "sum", "*", "Returns the sum of the values. Integer sum wraps around on overflow");
+        REGISTERF_BORROWED(aggregate_values<aggregate::min>, "min", "*", "Returns the smallest value or 0 if the array is empty");
+        REGISTERF_BORROWED(aggregate_values<aggregate::max>, "max", "*", "Returns the largest value or 0 if the array is empty");
+
+        static VMResultArray<T> asPArray(tes_context& ctx, ref obj) {
+            return tes_array::all_items<VMResultArray<T>>(ctx, obj);
+        }
+        REGISTERF2(asPArray, "*", "Copies all values to a new native Papyrus array");
+    };
+
+    typedef tes_numeric_array_t<SInt32, int32_t, array::layout::ints> tes_int_array;
+    typedef tes_numeric_array_t<Float32, float, array::layout::floats> tes_flt_array;
+
+    TES_META_INFO(tes_int_array);
+    TES_META_INFO(tes_flt_array);
+
+    JC_TEST(tes_int_array, packed_until_heterogeneous_insert)
+    {
+        array* arr = tes_int_array::object(context)->as<array>();
+        EXPECT_EQ(array::layout::ints, arr->u_layout());
+
+        for (int i = 10; i > 0; --i) {
+            tes_int_array::add(context, arr, i);
+        }
+        tes_array::replaceItemAtIndex<SInt32>(context, arr, 0, 100);    // same type, stays packed
+        tes_array::addItemAt<SInt32>(context, arr, 7);
+        EXPECT_EQ(array::layout::ints, arr->u_layout());
+
+        EXPECT_EQ(11, tes_array::count(context, arr));
+        EXPECT_EQ(100, tes_array::itemAtIndex<SInt32>(context, arr, 0));
+        EXPECT_EQ(2, tes_int_array::countValue(context, arr, 7));
+        EXPECT_EQ(100 + 9 * 10 / 2 + 7, tes_int_array::aggregate_values<tes_int_array::aggregate::sum>(context, arr));
+        EXPECT_EQ(1, tes_int_array::aggregate_values<tes_int_array::aggregate::min>(context, arr));
+        EXPECT_EQ(100, tes_int_array::aggregate_values<tes_int_array::aggregate::max>(context, arr));
+
+        tes_int_array::sort(context, arr);
+        EXPECT_EQ(1, tes_int_array::get(context, arr, 0));
+        EXPECT_EQ(100, tes_int_array::get(context, arr, -1));
+        EXPECT_EQ(6, tes_int_array::find(context, arr, 7));
+        EXPECT_EQ(7, tes_int_array::find(context, arr, 7, -1));
+        EXPECT_EQ(array::layout::ints, arr->u_layout());
+
+        tes_array::addItemAt<const char*>(context, arr, "str");
+        EXPECT_EQ(array::layout::items, arr->u_layout());
+        EXPECT_EQ(12, tes_array::count(context, arr));
+        EXPECT_EQ(100, tes_int_array::get(context, arr, -2));
+        EXPECT_EQ(6, tes_int_array::find(context, arr, 7));
+        EXPECT_EQ(1, tes_int_array::aggregate_values<tes_int_array::aggregate::min>(context, arr));
+    }
+
+    JC_TEST(tes_flt_array, packed_serialization)
+    {
+        auto& root = map::object(context);
+        context.set_root(&root);
+
+        array* arr = tes_flt_array::objectWithSize(context, 3)->as<array>();
+        tes_flt_array::set(context, arr, 1, 1.5f);
+        root.u_set("floats", *arr);
+
+        context.read_from_string(context.write_to_string());
+
+        array* loaded = context.root().u_get("floats")->object()->as<array>();
+        EXPECT_EQ(array::layout::floats, loaded->u_layout());
+        EXPECT_EQ(3, loaded->u_count());
+        EXPECT_EQ(1.5f, tes_flt_array::get(context, loaded, 1));
+    }
+
+    JC_TEST(tes_array, find_backwards)
+    {
+        array* generic = tes_object::object<array>(context);
+        array* packed = tes_int_array::object(context)->as<array>();
+        for (int v : { 1, 2, 3, 2 }) {
+            tes_array::addItemAt<SInt32>(context, generic, v);
+            tes_array::addItemAt<SInt32>(context, packed, v);
+        }
+
+        for (array* arr : { generic, packed }) {
+            EXPECT_EQ(1, tes_array::findVal<SInt32>(context, arr, 2));
+            EXPECT_EQ(3, tes_array::findVal<SInt32>(context, arr, 2, -1));
+            EXPECT_EQ(1, tes_array::findVal<SInt32>(context, arr, 2, -2));
+            EXPECT_EQ(-1, tes_array::findVal<SInt32>(context, arr, 3, -2));
+            EXPECT_EQ(2, tes_array::count_item<SInt32>(context, arr, 2));
+            EXPECT_EQ(-1, tes_array::findVal<Float32>(context, arr, 2.f));
+        }
+        EXPECT_EQ(array::layout::ints, packed->u_layout());
+
+        EXPECT_EQ(2, tes_array::erase_item<SInt32>(context, packed, 2));
+        EXPECT_EQ(2, tes_array::count(context, packed));
+        EXPECT_EQ(3, tes_int_array::get(context, packed, 1));
+    }
+
+    JC_TEST(tes_array, sort_by_path_keeps_packed)
+    {
+        array* packed = tes_flt_array::object(context)->as<array>();
+        for (float v : { 1.5f, -2.f, 3.25f }) {
+            tes_flt_array::add(context, packed, v);
+        }
+
+        tes_array::sortByPath(context, packed, "", false);
+        EXPECT_EQ(array::layout::floats, packed->u_layout());
+        EXPECT_EQ(3.25f, tes_flt_array::get(context, packed, 0));
+        EXPECT_EQ(-2.f, tes_flt_array::get(context, packed, -1));
+    }
+
+    JC_TEST(tes_array, scan_perft)
+    {
+        for (int size : { 1000, 100000, 1000000 }) {
+            array* generic = tes_array::objectWithSize(context, size)->as<array>();
+            array* packed = tes_int_array::objectWithSize(context, size)->as<array>();
+            for (int i = 0; i < size; ++i) {
+                generic->u_container()[i] = item(i % 100);
+                packed->u_ints()->at(i) = i % 100;
+            }
+
+            const int repeats = 100000000 / size;
+            for (array* arr : { generic, packed }) {
+                std::string name = std::string(arr == packed ? "JIntArray" : "JArray")
+                    + " findInt/countInteger/eraseInteger, " + std::to_string(size) + " items";
+                SInt32 found = 0;
+                util::do_with_timing(name.c_str(), [&]() {
+                    for (int i = 0; i < repeats; ++i) {
+                        found += tes_array::findVal<SInt32>(context, arr, 1000);   // not present: full scan
+                        found += tes_array::count_item<SInt32>(context, arr, 42);
+                        found += tes_array::erase_item<SInt32>(context, arr, 1000);
+                    }
+                });
+                EXPECT_EQ(repeats * (-1 + size / 100), found);
+            }
+        }
+    }
+}
@@ -199,7 +199,7 @@ JValue.cleanPool(\"uniquePoolName\")"
             JC_LOG_API ("0x%p", (void*) obj);
             return obj != nullptr;
         }
-        REGISTERF2(isExists, "*",
+        REGISTERF2_BORROWED(isExists, "*",
             "Tests whether given object identifier is not the null object.\n"
             "Note that many other API functions already check that too.");
 
@@ -208,17 +208,17 @@ JValue.cleanPool(\"uniquePoolName\")"
             return obj->as<T>() != nullptr;
         }
 
-        REGISTERF(isCast<array>, "isArray", "*", "Returns true if the object is map, array or formmap container");
-        REGISTERF(isCast<map>, "isMap", "*", nullptr);
-        REGISTERF(isCast<form_map>, "isFormMap", "*", nullptr);
-        REGISTERF(isCast<integer_map>, "isIntegerMap", "*", nullptr);
+        REGISTERF_BORROWED(isCast<array>, "isArray", "*", "Returns true if the object is map, array or formmap container");
+        REGISTERF_BORROWED(isCast<map>, "isMap", "*", nullptr);
+        REGISTERF_BORROWED(isCast<form_map>, "isFormMap", "*", nullptr);
+        REGISTERF_BORROWED(isCast<integer_map>, "isIntegerMap", "*", nullptr);
 
         static bool empty (tes_context& ctx, ref obj)
         {
             JC_LOG_API ("0x%p", (void*) obj);
             return count (ctx, obj) == 0;
         }
-        REGISTERF2(empty, "*", "Returns true, if the container is empty");
+        REGISTERF2_BORROWED(empty, "*", "Returns true, if the container is empty");
 
         static SInt32 count (tes_context& ctx, ref obj)
         {
@@ -229,7 +229,7 @@ JValue.cleanPool(\"uniquePoolName\")"
                 c = obj->s_count();
             return c;
         }
-        REGISTERF2(count, "*", "Returns amount of items in the container");
+        REGISTERF2_BORROWED(count, "*", "Returns amount of items in the container");
 
         static void clear(tes_context& ctx, ref obj)
         {
@@ -344,14 +344,14 @@ JValue.cleanPool(\"uniquePoolName\")"
             SInt32 type = item_type::no_item;
             if (obj && path)
             {
-                ca::visit_value(*obj, path, ca::constant, [&](const item& value) {
+                ca::read_value(*obj, path, [&](const item& value) {
                     type = value.type();
                 });
             }
             return type;
         }
 
-        REGISTERF(solvedValueType, "solvedValueType", "* path", "Returns type of resolved value. " VALUE_TYPE_COMMENT);
+        REGISTERF_BORROWED(solvedValueType, "solvedValueType", "* path", "Returns type of resolved value. " VALUE_TYPE_COMMENT);
 
         static bool hasPath(tes_context& ctx, object_base* obj, const char *path)
         {
@@ -359,7 +359,7 @@ JValue.cleanPool(\"uniquePoolName\")"
 
             return solvedValueType(ctx, obj, path) != item_type::no_item;
         }
-        REGISTERF(hasPath, "hasPath", "* path",
+        REGISTERF_BORROWED(hasPath, "hasPath", "* path",
 "Path resolving:\n\n\
 Returns true, if it's possible to resolve given path, i.e. if it's possible to retrieve the value at the path.\n\
 For ex. JValue.hasPath(container, \".player.health\") will test whether @container structure close to this one - {'player': {'health': health_value}}"
@@ -381,11 +381,11 @@ For ex. JValue.hasPath(container, \".player.health\") will test whether @contain
 
             return val;
         }
-        REGISTERF(resolveGetter<Float32>, "solveFlt", "* path default=0.0", "Attempts to retrieve value at given path. If fails, returns @default value");
-        REGISTERF(resolveGetter<SInt32>, "solveInt", "* path default=0", nullptr);
-        REGISTERF(resolveGetter<skse::string_ref>, "solveStr", "* path default=\"\"", nullptr);
-        REGISTERF(resolveGetter<Handle>, "solveObj", "* path default=0", nullptr);
-        REGISTERF(resolveGetter<form_ref>, "solveForm", "* path default=None", nullptr);
+        REGISTERF_BORROWED(resolveGetter<Float32>, "solveFlt", "* path default=0.0", "Attempts to retrieve value at given path. If fails, returns @default value");
+        REGISTERF_BORROWED(resolveGetter<SInt32>, "solveInt", "* path default=0", nullptr);
+        REGISTERF_BORROWED(resolveGetter<skse::string_ref>, "solveStr", "* path default=\"\"", nullptr);
+        REGISTERF_BORROWED(resolveGetter<Handle>, "solveObj", "* path default=0", nullptr);
+        REGISTERF_BORROWED(resolveGetter<form_ref>, "solveForm", "* path default=None", nullptr);
 
         template<class T>
         static bool solveSetter(tes_context& ctx, object_base* obj, const char* path, T value, bool createMissingKeys = false)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <future>
+#include <thread>
 #include "util/util.h"
 
 namespace tes_api_3 {
@@ -159,6 +160,52 @@ namespace tes_api_3 {
         }
     }
 
+    JC_TEST(path_resolving, aggregate_operators)
+    {
+        object_base *obj = tes_object::objectFromPrototype(context, STR(
+            { "a": {"gold": 10}, "b" : {"gold": 2.5}, "c" : {"name": "none"}, "d" : {"gold": 10}, "e" : 5 }
+        ));
+
+        EXPECT_EQ(22.5f, tes_object::resolveGetter<Float32>(context, obj, "@sum.value.gold"));
+        EXPECT_EQ(7.5f, tes_object::resolveGetter<Float32>(context, obj, "@avg.value.gold"));
+        EXPECT_EQ(3, tes_object::resolveGetter<SInt32>(context, obj, "@count.value.gold"));
+        EXPECT_EQ(5, tes_object::resolveGetter<SInt32>(context, obj, "@count.value"));
+        EXPECT_EQ(10, tes_object::resolveGetter<SInt32>(context, obj, "@first.value.gold"));
+        EXPECT_EQ(5, tes_object::resolveGetter<SInt32>(context, obj, "@last.value"));
+        EXPECT_EQ(5, tes_object::resolveGetter<SInt32>(context, obj, "@count.key"));
+
+        auto distinct = tes_object::resolveGetter<object_base*>(context, obj, "@distinct.value.gold");
+        EXPECT_EQ(2, tes_array::count(context, distinct->as<array>()));
+        EXPECT_EQ(2.5f, tes_array::itemAtIndex<Float32>(context, distinct->as<array>(), 1));
+
+        object_base *ints = tes_object::objectFromPrototype(context, STR([1, 2, 3, 4]));
+        EXPECT_EQ(10, tes_object::resolveGetter<SInt32>(context, ints, "@sum"));
+        EXPECT_EQ(2.5f, tes_object::resolveGetter<Float32>(context, ints, "@avg"));
+        EXPECT_FALSE(tes_object::hasPath(context, ints, "@sum,nonexistingOperator"));
+
+        // several aggregates, one traversal
+        auto summary = tes_object::resolveGetter<object_base*>(context, obj, "@sum,count,maxNum.value.gold");
+        EXPECT_EQ(22.5f, tes_object::resolveGetter<Float32>(context, summary, ".sum"));
+        EXPECT_EQ(3, tes_object::resolveGetter<SInt32>(context, summary, ".count"));
+        EXPECT_EQ(10, tes_object::resolveGetter<SInt32>(context, summary, ".maxNum"));
+    }
+
+    JC_TEST(path_resolving, aggregate_operators_perft)
+    {
+        map& root = map::object(context);
+        for (int i = 0; i < 5000; ++i) {
+            auto& entry = map::object(context);
+            entry.u_set("gold", item(i));
+            root.u_set(std::to_string(i).c_str(), item(entry));
+        }
+
+        util::do_with_timing("@avg.value.gold over 5000 entries, x1000", [&]() {
+            for (int i = 0; i < 1000; ++i) {
+                EXPECT_EQ(2499.5f, tes_object::resolveGetter<Float32>(context, &root, "@avg.value.gold"));
+            }
+        });
+    }
+
     TEST(path_resolving, explicit_key_construction)
     {
         tes_context_standalone  ctx;
@@ -207,6 +254,80 @@ namespace tes_api_3 {
         EXPECT_TRUE(itr == m->u_container().end());
     }
 
+    JC_TEST(tes_map, add_pairs_and_batches_dont_deadlock)
+    {
+        map& obj = map::object(context);
+        ca::assign_creative(obj, ".a.gold", 0);
+        ca::assign_creative(obj, ".b.gold", 0);
+        map* a = tes_object::resolveGetter<object_base*>(context, &obj, ".a")->as<map>();
+        map* b = tes_object::resolveGetter<object_base*>(context, &obj, ".b")->as<map>();
+
+        const int rounds = 20000;
+        std::thread copier([&]() {
+            for (int i = 0; i < rounds; ++i) {
+                tes_map::addPairs(context, i % 2 ? a : b, i % 2 ? b : a, true);
+            }
+        });
+
+        using namespace transaction;
+        std::vector<step<SInt32>> steps = { { ".b.gold", operation::add, 1 }, { ".a.gold", operation::add, 1 } };
+        for (int i = 0; i < rounds; ++i) {
+            EXPECT_TRUE(apply<SInt32>(obj, steps, 0, false) != boost::none);
+        }
+        copier.join();
+    }
+
+    JC_TEST(tes_array, queries)
+    {
+        object_base *arr = tes_object::objectFromPrototype(context, STR(
+            [{"name": "a", "gold": 10}, {"name": "B", "gold": 2.5}, {"name": "b", "gold": 30}, {"name": "c"}, 7]
+        ));
+        auto filtered = tes_array::filterBy<SInt32>(context, arr->as<array>(), ".gold", ">=", 10);
+        EXPECT_EQ(2, tes_array::count(context, filtered->as<array>()));
+        EXPECT_EQ(nullptr, tes_array::filterBy<SInt32>(context, arr->as<array>(), ".gold", "~", 10));
+
+        EXPECT_EQ(2, tes_array::countIf<const char*>(context, arr->as<array>(), ".name", "==", "b"));
+        EXPECT_EQ(3, tes_array::countIf<SInt32>(context, arr->as<array>(), ".gold", "!=", 10)); // no .gold counts too
+        EXPECT_EQ(1, tes_array::countIf<SInt32>(context, arr->as<array>(), "", "==", 7));
+
+        EXPECT_EQ(42.5f, tes_array::sumByPath(context, arr->as<array>(), ".gold"));
+        EXPECT_FLOAT_EQ(42.5f / 3, tes_array::avgByPath(context, arr->as<array>(), ".gold"));
+
+        tes_array::sortByPath(context, arr->as<array>(), ".gold", false);
+        EXPECT_EQ(30, tes_object::resolveGetter<SInt32>(context, arr, "[0].gold"));
+        EXPECT_EQ(2.5f, tes_object::resolveGetter<Float32>(context, arr, "[2].gold"));
+
+        object_base *groups = tes_map_ext::groupBy(context, arr, ".name");
+        EXPECT_EQ(3, tes_map::count(context, groups->as<map>()));
+        EXPECT_EQ(2, tes_array::count(context, tes_object::resolveGetter<object_base*>(context, groups, ".b")->as<array>()));
+        EXPECT_EQ(30, tes_object::resolveGetter<SInt32>(context, groups, ".b[0].gold"));  // sorted order kept
+    }
+
+    JC_TEST(tes_array, queries_parallel)
+    {
+        const int size = 20000;
+        array *arr = tes_object::object<array>(context);
+        for (int i = 0; i < size; ++i) {
+            auto& m = map::object(context);
+            m.u_set("gold", item(i % 100));
+            m.u_set("kind", item(i % 2 ? "odd" : "even"));
+            arr->u_push(item(m));
+        }
+
+        util::do_with_timing("JArray.countIfInt/sumByPath/sortByPath/groupBy, 20000 maps", [&]() {
+            EXPECT_EQ(size / 2, tes_array::countIf<SInt32>(context, arr, ".gold", "<", 50));
+            EXPECT_EQ(size / 100 * (99 * 100 / 2), (int)tes_array::sumByPath(context, arr, ".gold"));
+            EXPECT_EQ(size / 100, tes_array::count(context, tes_array::filterBy<SInt32>(context, arr, ".gold", "==", 99)->as<array>()));
+
+            tes_array::sortByPath(context, arr, ".gold");
+            EXPECT_EQ(0, tes_object::resolveGetter<SInt32>(context, arr, "[0].gold"));
+            EXPECT_EQ(99, tes_object::resolveGetter<SInt32>(context, arr, ("[" + std::to_string(size - 1) + "].gold").c_str()));
+
+            object_base *groups = tes_map_ext::groupBy(context, arr, ".kind");
+            EXPECT_EQ(size / 2, tes_array::count(context, tes_object::resolveGetter<object_base*>(context, groups, ".odd")->as<array>()));
+        });
+    }
+
     TEST(tes_object, pool)
     {
         tes_context_standalone ctx;
@@ -216,8 +337,7 @@ namespace tes_api_3 {
         tes_object::addToPool(ctx, object_stack_ref(obj), "locationA");
         auto id = obj->public_id();
 
-        EXPECT_TRUE(obj->_refCount == 1);
-        EXPECT_TRUE(obj->_stack_refCount == 0);
+        EXPECT_TRUE(obj->_refCount == 1); // the pool only, the stack reference is gone
 
         tes_object::cleanPool(ctx, "locationA");
 
@@ -12,6 +12,7 @@
 #include "collections/context.h"
 #include "collections/operators.h"
 #include "util/cstring.h"
+#include "util/epoch.h"
 
 namespace collections
 {
@@ -45,39 +46,95 @@ namespace collections
             }
         };
 
-        template<class T>
-        static bool _map_visit_helper(tes_context& context, T& container, path_type path, std::function<void(item *)>&& function)
-        {
-            if (path.empty()) {
-                return false;
-            }
+        // Locks a path step: the reads share the lock, creating the missing keys takes it exclusively
+        struct step_lock {
+            bs::optional<object_lock> write;
+            bs::optional<object_read_lock> read;
 
-            bool isKeyVisit = false;
+            step_lock(const object_base *obj, bool exclusive) {
+                if (exclusive) {
+                    write.emplace(obj);
+                }
+                else {
+                    read.emplace(obj);
+                }
+            }
+        };
 
-            path_type::iterator rightPath;
+        template<class F>
+        struct _values_visitor {
+            bool keys;
+            F* visit;
 
-            if (bs::istarts_with(path, ".key")) {
-                isKeyVisit = true;
-                rightPath = path.begin() + bs::size(".key") - 1;
+            void operator()(array& arr) {
+                for (uint32_t i = 0, count = arr.u_count(); i < count; ++i) {
+                    arr.u_read_at(i, *visit);   // packed arrays stay packed
+                }
             }
-            else if (bs::istarts_with(path, ".value")) {
-                isKeyVisit = false;
-                rightPath = path.begin() + bs::size(".value") - 1;
-            } else {
-                return false;
+
+            template<class Map>
+            void operator()(Map& cnt) {
+                item key;
+                for (auto& pair : cnt.u_container()) {
+                    if (keys) {
+                        key = pair.first;
+                        (*visit)(key);
+                    }
+                    else {
+                        (*visit)(pair.second);
+                    }
+                }
             }
+        };
+
+        // Visits the values of a collection under its lock, without copying it. The visitor must not lock other objects
+        template<class F>
+        static void _visit_values_locked(object_base& collection, bool keys, F&& visit)
+        {
+            _values_visitor<std::remove_reference_t<F>> helper{ keys, &visit };
+
+            object_read_lock g(collection);
+            perform_on_object(collection, helper);
+        }
 
-            auto copy = container.container_copy();
+        // Visits the items at the @path of each value (or key) of the collection. Maps require ".key" or ".value" path prefix.
+        // The values are visited under the lock if the rest of the path is empty, otherwise only the objects among
+        // them are snapshotted (keys and non-objects have nothing at a non-empty path) and resolved out of the lock
+        static bool _collection_visit_helper(tes_context& context, object_base& collection, path_type path, const std::function<void(item *)>& function)
+        {
+            bool isKeyVisit = false;
 
-            if (isKeyVisit) {
-                item itm;
-                for (auto &pair : copy) {
-                    itm = pair.first;
-                    resolve(context, itm, rightPath, function);
+            if (!collection.as<array>()) {
+                if (bs::istarts_with(path, ".key")) {
+                    isKeyVisit = true;
+                    path = path_type(path.begin() + bs::size(".key") - 1, path.end());
+                }
+                else if (bs::istarts_with(path, ".value")) {
+                    path = path_type(path.begin() + bs::size(".value") - 1, path.end());
+                }
+                else {
+                    return false;
                 }
-            } else { // is value visit
-                for (auto &pair : copy) {
-                    resolve(context, pair.second, rightPath, function);
+            }
+
+            if (path.empty()) {
+                _visit_values_locked(collection, isKeyVisit, [&function](const item& itm) {
+                    function(const_cast<item *>(&itm));
+                });
+            }
+            else if (!isKeyVisit) {
+                // the pin keeps the values in memory once the collection is unlocked, no need to reference them
+                util::epoch::guard pin;
+                std::vector<object_base*> objects;
+                _visit_values_locked(collection, false, [&objects](const item& itm) {
+                    if (auto obj = itm.object()) {
+                        objects.push_back(obj);
+                    }
+                });
+
+                const ss::string rightPath(path.begin(), path.end());
+                for (auto obj : objects) {
+                    resolve(context, obj, rightPath.c_str(), function);
                 }
             }
 
@@ -142,46 +199,43 @@ namespace collections
                     return state(false, st);
                 }
 
-                auto opr = operators::get_operator(operationStr.c_str());
-
-                if (!opr) {
-                    return state(false, st);
+                // "@sum,avg,count" computes all of them in one pass
+                ss::vector<operators::coll_operator*> oprs;
+                ss::vector<std::string> names;
+                bs::split(names, operationStr, bs::is_any_of(","));
+                for (auto& name : names) {
+                    auto opr = operators::get_operator(name.c_str());
+                    if (!opr) {
+                        return state(false, st);
+                    }
+                    oprs.push_back(opr);
                 }
 
-                item sharedItem;
+                ss::vector<operators::accumulator> accumulators(oprs.size());
 
                 auto itemVisitFunc = [&](item *item) {
                     if (item) {
-                        opr->func(*item, sharedItem);
-                    }
-                };
-
-                struct 
-                {
-                    decltype(context)       context;
-                    decltype(rightPath)     *rightPath;
-                    decltype(itemVisitFunc) *visitFunc;
-
-                    void operator()(array& arr) {
-                        // have to copy array to prevent its modification during iteration
-                        auto array_copy = arr.container_copy();
-                        for (auto &itm : array_copy) {
-                            resolve(context, itm, rightPath->begin(), *visitFunc);
+                        for (size_t i = 0; i < oprs.size(); ++i) {
+                            oprs[i]->func(*item, accumulators[i]);
                         }
                     }
-                    void operator()(map& cnt) {
-                        _map_visit_helper(context, cnt, *rightPath, *visitFunc);
-                    }
-                    void operator()(form_map& cnt) {
-                        _map_visit_helper(context, cnt, *rightPath, *visitFunc);
-                    }
-                    void operator()(integer_map& cnt) {
-                        _map_visit_helper(context, cnt, *rightPath, *visitFunc);
-                    }
+                };
 
-                } helper{ context, &rightPath, &itemVisitFunc };
+                _collection_visit_helper(context, *collection, rightPath, itemVisitFunc);
 
-                perform_on_object(*collection, helper);
+                item sharedItem;
+                if (oprs.size() == 1) {
+                    sharedItem = oprs.front()->result(accumulators.front(), context);
+                }
+                else {
+                    // a map of the operator names to their results
+                    sharedItem = item(map::objectWithInitializer([&](map& results) {
+                        for (size_t i = 0; i < oprs.size(); ++i) {
+                            results.u_get_or_create(oprs[i]->func_name) = oprs[i]->result(accumulators[i], context);
+                        }
+                    },
+                        context));
+                }
 
                 return state(true,
                     [=](object_base *) mutable -> item* { return &sharedItem;},
@@ -204,10 +258,13 @@ namespace collections
                     return state(false, st);
                 }
 
-                object_lock lock(st.object);
+                step_lock lock(st.object, createMissingKeys);
                 auto node = st.nodeGetter(st.object);
 
                 if (createMissingKeys && node && node->isNull()) {
+                    if (auto owner = st.object->as<map>()) {
+                        owner->u_changed();
+                    }
                     *node = map::object(context);
                 }
 
@@ -237,7 +294,7 @@ namespace collections
                                 path_type(end, path.end()) );
             };
 
-            auto arrayRule = [&context](const state &st) -> state {
+            auto arrayRule = [createMissingKeys, &context](const state &st) -> state {
 
                 const auto& path = st.path;
 
@@ -274,7 +331,7 @@ namespace collections
                         return state (false, st);
                 }
 
-                object_lock lock(st.object);
+                step_lock lock(st.object, createMissingKeys);
                 auto container = st.nodeGetter(st.object)->object();
 
                 if (!container) {
@@ -282,9 +339,18 @@ namespace collections
                 }
 
                 return state(   true,
-                                [=, &context](object_base* container) {
-                                    if (container->as<array>()) {
-                                        return container->as<array>()->u_get(indexOrFormId);
+                                [=, &context, scratch = item()](object_base* container) mutable {
+                                    if (auto arr = container->as<array>()) {
+                                        // a shared walk reads a packed number into the scratch item, the array stays packed
+                                        if (!createMissingKeys && arr->u_layout() != array::layout::items) {
+                                            auto idx = arr->u_convertIndex(indexOrFormId);
+                                            if (!idx) {
+                                                return (item *)nullptr;
+                                            }
+                                            arr->u_read_at(*idx, [&scratch](const item& itm) { scratch = itm; });
+                                            return &scratch;
+                                        }
+                                        return arr->u_get(indexOrFormId);
                                     }
                                     else if (container->as<form_map>()) {
                                         return container->as<form_map>()->u_get(make_weak_form_id(frmId, context));
@@ -319,7 +385,7 @@ namespace collections
                 if (st.path.empty() && anySucceed) {
 
                     if (st.object) {
-                        object_lock lock(st.object);
+                        step_lock lock(st.object, createMissingKeys);
                         itemFunction( st.nodeGetter(st.object));
                     } else {
                         itemFunction( st.nodeGetter(nullptr));
@@ -352,6 +418,11 @@ namespace collections
         using cstring = util::cstring;
         //using keys = std::vector<key_variant>;
 
+        template<class R, class Arg>
+        boost::none_t parse_path_helper(Arg&&) {
+            return boost::none;
+        }
+
         template<class R, class Arg, class F1, class ... F>
         boost::optional<R> parse_path_helper(Arg&& a, F1&& f1, F&& ... funcs) {
             auto result = f1(std::forward<Arg>(a));
@@ -363,11 +434,6 @@ namespace collections
             }
         };
 
-        template<class R, class Arg>
-        boost::none_t parse_path_helper(Arg&&) {
-            return boost::none;
-        }
-
         struct key_and_rest {
             key_variant key;
             cstring rest_of_path;
@@ -442,9 +508,10 @@ namespace collections
                 if (!key) {
                     return bs::none;
                 }
-                object_lock lock(collection);
-                auto itemPtr = u_access_value(collection, key->key);
-                return itemPtr ? bs::make_optional(itemPtr->object()) : bs::none;
+                object_read_lock lock(collection);
+                bs::optional<object_base*> result;
+                u_read_value(collection, key->key, [&result](const item& itm) { result = itm.object(); });
+                return result;
             }
         };
 
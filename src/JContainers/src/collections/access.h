@@ -16,6 +16,7 @@ namespace collections
 
     namespace path_resolving {
 
+        // Unless @createMissingKeys, the path is walked under the shared locks: the @itemFunction must not write into the item
         void resolve(tes_context& ctx, item& target, const char *cpath,
             const std::function<void(item *)>& itemFunction, bool createMissingKeys = false);
 
@@ -40,10 +41,15 @@ namespace collections
 
         using key_variant = boost::variant<int32_t, std::string, form_ref>;
 
+        // the key_variant's type which addresses the collection's keys
+        template<class Collection> struct variant_key { using type = typename Collection::key_type; };
+        template<> struct variant_key<map> { using type = std::string; };
+        template<class Collection> using variant_key_t = typename variant_key<Collection>::type;
+
         struct u_access_value_helper {
             template<class Collection>
             item* operator () (Collection& collection, const key_variant& key) {
-                if (auto idx = bs::get<typename Collection::key_type>(&key)) {
+                if (auto idx = bs::get<variant_key_t<Collection>>(&key)) {
                     return collection.u_get(*idx);
                 }
                 return nullptr;
@@ -55,11 +61,42 @@ namespace collections
         };
         // 
 
+        template<class Func>
+        struct u_read_value_helper {
+            Func& func;
+
+            bool operator () (const array& arr, const key_variant& key) {
+                auto idx = bs::get<int32_t>(&key);
+                auto converted = idx ? arr.u_convertIndex(*idx) : bs::none;
+                if (converted) {
+                    arr.u_read_at(*converted, func);
+                }
+                return converted.is_initialized();
+            }
+
+            template<class Collection>
+            bool operator () (const Collection& collection, const key_variant& key) {
+                auto idx = bs::get<variant_key_t<Collection>>(&key);
+                auto itm = idx ? collection.u_get(*idx) : nullptr;
+                if (itm) {
+                    func(*itm);
+                }
+                return itm != nullptr;
+            }
+        };
+
+        // Calls @func with the const item at the @key, a packed number as a temporary item: the read changes nothing,
+        // the collection may be locked shared. False if there is no item
+        template<class Func>
+        inline bool u_read_value(const object_base& collection, const key_variant& key, Func&& func) {
+            return perform_on_object_and_return<bool>(collection, u_read_value_helper<std::remove_reference_t<Func>>{ func }, key);
+        }
+
         template<class Value>
         struct u_assign_value_helper {
             template<class T>
             item* operator()(T& obj, const key_variant& key, Value&& value) {
-                if (auto idx = bs::get<typename T::key_type>(&key)) {
+                if (auto idx = bs::get<variant_key_t<T>>(&key)) {
                     return obj.u_set(*idx, std::forward<Value>(value));
                 }
                 return nullptr;
@@ -75,7 +112,7 @@ namespace collections
         struct u_erase_key_helper {
             template<class T>
             bool operator()(T& obj, const key_variant& key) {
-                if (auto idx = bs::get<typename T::key_type>(&key)) {
+                if (auto idx = bs::get<variant_key_t<T>>(&key)) {
                     return obj.u_erase(*idx);
                 }
                 return false;
@@ -108,15 +145,23 @@ namespace collections
         inline bs::optional<item> get(object_base& target, const char *cpath) {
             auto ac_info = access_constant(target, cpath);
             if (ac_info) {
-                object_lock g(ac_info->collection);
-                auto itmPtr = u_access_value(ac_info->collection, ac_info->key);
-                return _opt_from_pointer(itmPtr);
+                object_read_lock g(ac_info->collection);
+                bs::optional<item> result;
+                u_read_value(ac_info->collection, ac_info->key, [&result](const item& itm) { result = itm; });
+                return result;
             }
             else {
                 return bs::none;
             }
         }
 
+        // the @collection's value may get written through a pointer
+        inline void u_value_exposed(object_base& collection) {
+            if (auto m = collection.as<map>()) {
+                m->u_changed();
+            }
+        }
+
         template<class Func, class ...Args>
         inline bool visit_value(object_base& target, const char *cpath, access_way way, Func f, Args&&... args) {
             auto ac_info = (way == constant ? access_constant(target, cpath) : access_creative(target, cpath));
@@ -124,6 +169,7 @@ namespace collections
                 object_lock g(ac_info->collection);
                 auto itmPtr = u_access_value(ac_info->collection, ac_info->key);
                 if (itmPtr) {
+                    u_value_exposed(ac_info->collection);
                     f(*itmPtr, std::forward<Args>(args)...);
                 }
                 return itmPtr != nullptr;
@@ -133,13 +179,27 @@ namespace collections
             }
         }
 
+        // visits the value without changing it: shares the lock and leaves the root snapshot valid
+        template<class Func>
+        inline bool read_value(object_base& target, const char *cpath, Func f) {
+            auto ac_info = access_constant(target, cpath);
+            if (ac_info) {
+                object_read_lock g(ac_info->collection);
+                return u_read_value(ac_info->collection, ac_info->key, f);
+            }
+            else {
+                return false;
+            }
+        }
+
         template<class Value>
         inline bs::optional<Value> get(object_base& target, const char *cpath) {
             auto ac_info = access_constant(target, cpath);
             if (ac_info) {
-                object_lock g(ac_info->collection);
-                auto itmPtr = u_access_value(ac_info->collection, ac_info->key);
-                return itmPtr ? _opt_from_pointer(itmPtr->get<Value>()) : bs::none;
+                object_read_lock g(ac_info->collection);
+                bs::optional<Value> result;
+                u_read_value(ac_info->collection, ac_info->key, [&result](const item& itm) { result = _opt_from_pointer(itm.get<Value>()); });
+                return result;
             }
             else {
                 return bs::none;
@@ -154,6 +214,7 @@ namespace collections
                 if (way == constant) {
                     auto itmPtr = u_access_value(ac_info->collection, ac_info->key);
                     if (itmPtr) {
+                        u_value_exposed(ac_info->collection);
                         *itmPtr = std::forward<Value>(value);
                     }
                     return itmPtr != nullptr;
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "util/util.h"
+#include "collections/test_fixture.h"
+#include "collections/access.h"
+#include "collections/json_serialization.h"
+
+/**
+ * Timings of the core operations over 1k..1M objects: creation, handle lookup, JMap access,
+ * path resolving, garbage collection, JSON and save/load round trips.
+ * The standalone context is all they need, no game is involved: the jcontainers_benchmarks executable
+ * of the core build runs them too. Filter them with *_perft
+ */
+
+#ifndef TEST_COMPILATION_DISABLED
+
+namespace collections {
+
+    namespace benchmarks {
+
+        static const int scales[] = { 1000, 10000, 100000, 1000000 };
+
+        // GC, JSON and save/load walk the whole graph, the largest scale would take minutes
+        static const int graph_scales[] = { 1000, 10000, 100000 };
+
+        inline std::string timing_name(const char *operation, int scale) {
+            return std::string(operation) + ", " + std::to_string(scale) + " objects";
+        }
+
+        /// A map of @count entries, each {"gold": i, "name": "entry_i"}, set as the root of the @ctx
+        inline map& make_entries(tes_context& ctx, int count) {
+            map& root = map::object(ctx);
+            for (int i = 0; i < count; ++i) {
+                map& entry = map::object(ctx);
+                entry.u_set("gold", item(i));
+                entry.u_set("name", item("entry_" + std::to_string(i)));
+                root.u_set("key_" + std::to_string(i), item(entry));
+            }
+            ctx.set_root(&root);
+            return root;
+        }
+    }
+
+    JC_TEST(benchmarks, object_creation_perft)
+    {
+        for (int scale : benchmarks::scales) {
+            util::do_with_timing(benchmarks::timing_name("JMap.object", scale).c_str(), [&]() {
+                for (int i = 0; i < scale; ++i) {
+                    map::object(context);
+                }
+            });
+            context.collect_garbage();
+        }
+    }
+
+    JC_TEST(benchmarks, handle_lookup_perft)
+    {
+        for (int scale : benchmarks::scales) {
+            std::vector<Handle> handles;
+            handles.reserve(scale);
+            for (int i = 0; i < scale; ++i) {
+                handles.push_back(array::object(context).uid());
+            }
+
+            size_t found = 0;
+            util::do_with_timing(benchmarks::timing_name("handle lookup x10", scale).c_str(), [&]() {
+                for (int repeat = 0; repeat < 10; ++repeat) {
+                    for (Handle hdl : handles) {
+                        found += context.getObject(hdl) != nullptr;
+                    }
+                }
+            });
+            EXPECT_EQ(size_t(scale) * 10, found);
+            context.collect_garbage();
+        }
+    }
+
+    JC_TEST(benchmarks, map_access_perft)
+    {
+        for (int scale : benchmarks::scales) {
+            map::ref m = &map::object(context);
+            std::vector<std::string> keys;
+            keys.reserve(scale);
+            for (int i = 0; i < scale; ++i) {
+                keys.push_back("key_" + std::to_string(i));
+            }
+
+            util::do_with_timing(benchmarks::timing_name("JMap.setInt", scale).c_str(), [&]() {
+                for (int i = 0; i < scale; ++i) {
+                    m->set(keys[i], item(i));
+                }
+            });
+
+            SInt32 sum = 0;
+            util::do_with_timing(benchmarks::timing_name("JMap.getInt", scale).c_str(), [&]() {
+                for (int i = 0; i < scale; ++i) {
+                    object_read_lock g(m);
+                    sum += m->u_get(keys[i])->intValue() & 1;
+                }
+            });
+            EXPECT_EQ(scale / 2, sum);
+            m = nullptr;
+            context.collect_garbage();
+        }
+    }
+
+    JC_TEST(benchmarks, path_resolving_perft)
+    {
+        for (int scale : benchmarks::graph_scales) {
+            map& root = benchmarks::make_entries(context, scale);
+            std::vector<std::string> paths;
+            paths.reserve(scale);
+            for (int i = 0; i < scale; ++i) {
+                paths.push_back(".key_" + std::to_string(i) + ".gold");
+            }
+
+            SInt32 matched = 0;
+            util::do_with_timing(benchmarks::timing_name("JValue.solveInt", scale).c_str(), [&]() {
+                for (int i = 0; i < scale; ++i) {
+                    matched += ca::get<SInt32>(root, paths[i].c_str()).get_value_or(-1) == i;
+                }
+            });
+            EXPECT_EQ(scale, matched);
+
+            util::do_with_timing(benchmarks::timing_name("JValue.solveIntSetter", scale).c_str(), [&]() {
+                for (int i = 0; i < scale; ++i) {
+                    ca::assign(root, paths[i].c_str(), -i);
+                }
+            });
+            EXPECT_EQ(-1, ca::get<SInt32>(root, ".key_1.gold").get_value_or(0));
+        }
+    }
+
+    JC_TEST(benchmarks, garbage_collection_perft)
+    {
+        for (int scale : benchmarks::graph_scales) {
+            benchmarks::make_entries(context, scale);
+            context.collect_garbage(); // the previous root
+            // the same number of unreachable objects, every one in a cycle
+            for (int i = 0; i < scale; ++i) {
+                array::objectWithInitializer([](array& me) { me.u_push(item(me)); }, context);
+            }
+
+            size_t collected = 0;
+            util::do_with_timing(benchmarks::timing_name("garbage collection", scale * 2).c_str(), [&]() {
+                collected = context.collect_garbage();
+            });
+            EXPECT_EQ(size_t(scale), collected);
+        }
+    }
+
+    JC_TEST(benchmarks, json_round_trip_perft)
+    {
+        for (int scale : benchmarks::graph_scales) {
+            map& root = benchmarks::make_entries(context, scale);
+
+            std::string data;
+            util::do_with_timing(benchmarks::timing_name("JSON write", scale).c_str(), [&]() {
+                data = json_serializer::create_json_data(root).get();
+            });
+
+            object_base* loaded = nullptr;
+            util::do_with_timing(benchmarks::timing_name("JSON read", scale).c_str(), [&]() {
+                loaded = json_deserializer::object_from_json_data(context, data.c_str());
+            });
+            ASSERT_TRUE(loaded && loaded->as<map>());
+            EXPECT_EQ(scale, loaded->as<map>()->s_count());
+        }
+    }
+
+    JC_TEST(benchmarks, save_load_perft)
+    {
+        for (int scale : benchmarks::graph_scales) {
+            benchmarks::make_entries(context, scale);
+
+            std::string data;
+            util::do_with_timing(benchmarks::timing_name("save", scale).c_str(), [&]() {
+                data = context.write_to_string();
+            });
+            util::do_with_timing(benchmarks::timing_name("load", scale).c_str(), [&]() {
+                context.read_from_string(data);
+            });
+            EXPECT_EQ(scale, context.root().s_count());
+        }
+    }
+}
+
+#endif
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "skse64/GameForms.h"
+
 #include "util/stl_ext.h"
 #include "skse/skse.h"
 #include "reflection/tes_binding.h"
@@ -26,6 +28,15 @@ namespace reflection { namespace binding {
                 JC_log ("Warning: access to non-existing object with id 0x%X (%d)", hdl, hdl);
             return ref;
         }
+
+        // the caller pins util::epoch for the time it uses the object
+        static T* borrow2J (HandleT hdl, tes_context& ctx)
+        {
+            auto obj = ctx.getObjectOfType<T> ((Handle) hdl);
+            if (!obj && hdl != util::to_integral (Handle::Null))
+                JC_log ("Warning: access to non-existing object with id 0x%X (%d)", hdl, hdl);
+            return obj;
+        }
     };
 
     template<> struct GetConv < object_stack_ref > : ObjectConverter<>{};
@@ -40,6 +51,12 @@ namespace reflection { namespace binding {
 
     template<> struct GetConv < Handle > : StaticCastValueConverter<Handle, HandleT> {};
 
+    template<> struct GetConv < util::interned_string > : StringConverter {
+        static skse::string_ref convert2Tes(const util::interned_string& str) {
+            return skse::string_ref(str.c_str());
+        }
+    };
+
     //////////////////////////////////////////////////////////////////////////
 
     template<> struct GetConv < FormId > {
@@ -49,7 +66,7 @@ namespace reflection { namespace binding {
         }
         template<class Any>
         static FormId convert2J(const TESForm* form, const Any&) {
-            return form ? (FormId)form->formID : FormId::Zero;
+            return form ? skse::form_id(*form) : FormId::Zero;
         }
     };
 
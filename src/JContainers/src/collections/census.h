@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "jansson.h"
+
+#include "util/epoch.h"
+#include "collections/collections.h"
+#include "collections/context.h"
+
+namespace collections {
+
+    /// Heap census of a context: objects, items, string bytes and forms per collection type, per tag
+    /// and per JDB key. An object belongs to the first JDB key (in the key order) it is reachable from.
+    /// The objects are measured one by one, each under its own lock, the scripts aren't stopped. An object
+    /// deleted during the census is counted, empty
+    namespace census {
+
+        static const char* const untagged = "<untagged>";
+        static const char* const no_key = "<none>";     // JDB doesn't reach the object
+        static const char* const root_key = "<root>";   // the JDB map itself
+
+        struct usage {
+            uint64_t objects = 0;
+            uint64_t items = 0;
+            uint64_t string_bytes = 0;  // string values and JMap keys
+            uint64_t forms = 0;         // form values and JFormMap keys
+
+            usage& operator += (const usage& other) {
+                objects += other.objects;
+                items += other.items;
+                string_bytes += other.string_bytes;
+                forms += other.forms;
+                return *this;
+            }
+        };
+
+        struct report {
+            usage total;
+            std::map<std::string, usage> types;
+            std::map<std::string, usage> tags;
+            std::map<std::string, usage> jdb_keys;
+        };
+
+        inline const char* type_name(CollectionType type) {
+            switch (type) {
+            case CollectionType::Array:         return "JArray";
+            case CollectionType::Map:           return "JMap";
+            case CollectionType::FormMap:       return "JFormMap";
+            case CollectionType::IntegerMap:    return "JIntMap";
+            default:                            return "unknown";
+            }
+        }
+
+        /// The usage of the @obj itself, not of the objects it references. The @obj must be locked
+        inline usage u_measure(object_base& obj) {
+            struct {
+                usage u;
+
+                void value(const item& itm) {
+                    if (auto str = itm.get<std::string>()) {
+                        u.string_bytes += str->size();
+                    }
+                    else if (itm.is_type<form_ref>()) {
+                        ++u.forms;
+                    }
+                }
+
+                void key(const util::interned_string& k) { u.string_bytes += k.size(); }
+                void key(const form_ref&) { ++u.forms; }
+                void key(int32_t) {}
+
+                void operator()(array& arr) {
+                    if (arr.u_layout() == array::layout::items) { // packed numbers are neither strings nor forms
+                        for (auto& itm : arr.u_container()) {
+                            value(itm);
+                        }
+                    }
+                }
+
+                template<class Map>
+                void operator()(Map& cnt) {
+                    for (auto& pair : cnt.u_container()) {
+                        key(pair.first);
+                        value(pair.second);
+                    }
+                }
+            } helper;
+
+            perform_on_object(obj, helper);
+            helper.u.objects = 1;
+            helper.u.items = (uint64_t)obj.u_count();
+            return helper.u;
+        }
+
+        inline report take(tes_context& ctx) {
+            // keeps the objects in memory during the census, no need to reference each one
+            util::epoch::guard pin;
+            auto objects = ctx.registry->pinned_objects();
+
+            std::unordered_map<object_base*, const std::string*> owners;
+            owners.reserve(objects.size());
+            for (auto obj : objects) {
+                owners.emplace(obj, nullptr);
+            }
+
+            std::deque<std::string> key_names;
+            auto own = [&](object_base* obj, const std::string* key) {
+                auto itr = owners.find(obj); // an object created after the snapshot isn't counted
+                if (itr == owners.end() || itr->second) {
+                    return false;
+                }
+                itr->second = key;
+                return true;
+            };
+
+            map& root = ctx.root();
+            key_names.push_back(root_key);
+            own(&root, &key_names.back());
+
+            std::vector<std::pair<std::string, object_base*>> top_level;
+            {
+                object_read_lock g(root);
+                for (auto& pair : root.u_container()) {
+                    if (auto obj = pair.second.object()) {
+                        top_level.emplace_back(pair.first.str(), obj);
+                    }
+                }
+            }
+
+            std::vector<object_base*> to_visit;
+            for (auto& pair : top_level) {
+                key_names.push_back(pair.first);
+                const std::string* key = &key_names.back();
+                if (!own(pair.second, key)) {
+                    continue;
+                }
+
+                to_visit.push_back(pair.second);
+                while (!to_visit.empty()) {
+                    object_base* obj = to_visit.back();
+                    to_visit.pop_back();
+
+                    object_read_lock g(obj);
+                    obj->u_visit_referenced_objects([&](object_base& referenced) {
+                        if (own(&referenced, key)) {
+                            to_visit.push_back(&referenced);
+                        }
+                    });
+                }
+            }
+
+            report result;
+            for (auto obj : objects) {
+                usage u;
+                std::string tag;
+                {
+                    object_read_lock g(obj);
+                    u = u_measure(*obj);
+                    tag = obj->u_tag().c_str();
+                }
+
+                const std::string* key = owners[obj];
+                result.total += u;
+                result.types[type_name(obj->type())] += u;
+                result.tags[tag.empty() ? untagged : tag] += u;
+                result.jdb_keys[key ? *key : no_key] += u;
+            }
+            return result;
+        }
+
+        namespace detail {
+
+            inline json_t* usage_to_json(const usage& u) {
+                json_t* js = json_object();
+                json_object_set_new(js, "objects", json_integer((json_int_t)u.objects));
+                json_object_set_new(js, "items", json_integer((json_int_t)u.items));
+                json_object_set_new(js, "stringBytes", json_integer((json_int_t)u.string_bytes));
+                json_object_set_new(js, "forms", json_integer((json_int_t)u.forms));
+                return js;
+            }
+
+            inline json_t* usages_to_json(const std::map<std::string, usage>& usages) {
+                json_t* js = json_object();
+                for (auto& pair : usages) {
+                    json_object_set_new(js, pair.first.c_str(), usage_to_json(pair.second));
+                }
+                return js;
+            }
+        }
+
+        inline json_t* to_json(const report& r) {
+            json_t* js = json_object();
+            json_object_set_new(js, "total", detail::usage_to_json(r.total));
+            json_object_set_new(js, "types", detail::usages_to_json(r.types));
+            json_object_set_new(js, "tags", detail::usages_to_json(r.tags));
+            json_object_set_new(js, "jdbKeys", detail::usages_to_json(r.jdb_keys));
+            return js;
+        }
+    }
+}
@@ -6,7 +6,6 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/variant.hpp>
-#include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/weak_ptr.hpp>
 
 #include <boost/serialization/split_member.hpp>
@@ -23,10 +22,12 @@
 
 #include "gtest.h"
 #include "util/stl_ext.h"
+#include "util/profiling.h"
 
 #include "intrusive_ptr.hpp"
 #include "intrusive_ptr_serialization.hpp"
 #include "util/istring_serialization.h"
+#include "util/string_pool_serialization.h"
 #include "iarchive_with_blob.h"
 
 #include "object/object_base_serialization.h"
@@ -44,6 +45,8 @@ BOOST_CLASS_EXPORT_GUID(collections::map, "kJMap");
 BOOST_CLASS_EXPORT_GUID(collections::form_map, "kJFormMap");
 BOOST_CLASS_EXPORT_GUID(collections::integer_map, "kJIntegerMap");
 
+BOOST_CLASS_VERSION(collections::array, 1)
+BOOST_CLASS_VERSION(collections::map, 1)
 BOOST_CLASS_VERSION(collections::form_map, 1)
 BOOST_CLASS_VERSION(collections::item, 3)
 
@@ -80,7 +83,8 @@ namespace collections {
             using variant_old = boost::variant<boost::blank, SInt32, Real, FormId, internal_object_ref, std::string>;
             variant_old var;
             ar >> var;
-            var.apply_visitor(converter_324_to_330<Archive>{ _var, ar });
+            converter_324_to_330<Archive> converter{ _var, ar };
+            var.apply_visitor(converter);
         }
             break;
 
@@ -99,24 +103,74 @@ namespace collections {
 
     template<class Archive>
     void array::serialize(Archive & ar, const unsigned int version) {
+        util::profiling::object_scope p{ "JArray" };
         ar & boost::serialization::base_object<object_base>(*this);
-        ar & _array;
+
+        switch (version) {
+        default:
+            BOOST_ASSERT_MSG(false, "invalid array version");
+            break;
+        case 0:     // v4.2.13 and below: items only
+            ar & _array;
+            break;
+        case 1:
+            ar & _layout;
+            switch (_layout) {
+            case layout::ints:
+                ar & _ints;
+                break;
+            case layout::floats:
+                ar & _floats;
+                break;
+            default:
+                _layout = layout::items;
+                ar & _array;
+                break;
+            }
+            break;
+        }
     }
 
     template<class Archive>
-    void map::serialize(Archive & ar, const unsigned int version) {
+    void map::save(Archive & ar, const unsigned int version) const {
+        util::profiling::object_scope p{ "JMap" };
         ar & boost::serialization::base_object<object_base>(*this);
         ar & cnt;
     }
 
+    template<class Archive>
+    void map::load(Archive & ar, const unsigned int version) {
+        util::profiling::object_scope p{ "JMap" };
+        ar & boost::serialization::base_object<object_base>(*this);
+
+        switch (version) {
+        default:
+            BOOST_ASSERT_MSG(false, "invalid map version");
+            break;
+        case 0: {   // v4.2.13 and below: plain string keys
+            std::map<std::string, item> oldMap;
+            ar >> oldMap;
+            for (auto& pair : oldMap) {
+                cnt.emplace(value_type{ pair.first, std::move(pair.second) });
+            }
+        }
+            break;
+        case 1:
+            ar & cnt;
+            break;
+        }
+    }
+
     template<class Archive>
     void form_map::save(Archive & ar, const unsigned int version) const {
+        util::profiling::object_scope p{ "JFormMap" };
         ar & boost::serialization::base_object<object_base>(*this);
         ar & cnt;
     }
 
     template<class Archive>
     void form_map::load(Archive & ar, const unsigned int version) {
+        util::profiling::object_scope p{ "JFormMap" };
         ar & boost::serialization::base_object<object_base>(*this);
 
         switch (version) {
@@ -143,6 +197,7 @@ namespace collections {
 
     template<class Archive>
     void integer_map::serialize(Archive & ar, const unsigned int version) {
+        util::profiling::object_scope p{ "JIntMap" };
         ar & boost::serialization::base_object<object_base>(*this);
         ar & cnt;
     }
@@ -151,11 +206,106 @@ namespace collections {
 
     void form_map::u_onLoaded() {
 
-        util::tree_erase_if(cnt, [](const value_type& pair){
-            return pair.first.is_expired();
+        util::tree_erase_if(cnt, [this](const value_type& pair){
+            if (pair.first.is_expired()) {
+                u_key_removed(pair.first);
+                return true;
+            }
+            return false;
         });
     }
 
+    form_map::~form_map() {
+        if (is_completely_initialized() && HACK_get_tcontext(*this)._form_map_index.enabled()) {
+            for (auto& pair : cnt) {
+                u_key_removed(pair.first);
+            }
+        }
+    }
+
+    void form_map::u_clear() {
+        if (HACK_get_tcontext(*this)._form_map_index.enabled()) {
+            for (auto& pair : cnt) {
+                u_key_removed(pair.first);
+            }
+        }
+        cnt.clear();
+    }
+
+    void form_map::u_assign(const form_map& other) {
+        u_clear();
+        cnt = other.cnt;
+        u_index_keys();
+    }
+
+    void map::u_changed() {
+        if (is_completely_initialized()) {
+            HACK_get_tcontext(*this)._root_snapshot.u_changed(*this);
+        }
+    }
+
+    void map::u_clear() {
+        base::u_clear();
+        u_changed();
+    }
+
+    void form_map::u_key_added(const form_ref& key) {
+        auto& index = HACK_get_tcontext(*this)._form_map_index;
+        if (index.enabled()) {
+            index.add(key.get_raw(), *this);
+        }
+    }
+
+    void form_map::u_key_removed(const form_ref& key) {
+        auto& index = HACK_get_tcontext(*this)._form_map_index;
+        if (index.enabled()) {
+            index.remove(key.get_raw(), *this);
+        }
+    }
+
+    // idempotent: a map which has reported some of its keys already doesn't get listed twice for them
+    void form_map::u_index_keys() {
+        auto& index = HACK_get_tcontext(*this)._form_map_index;
+        if (!index.enabled()) {
+            return;
+        }
+
+        std::vector<FormId> ids;
+        ids.reserve(cnt.size());
+        for (auto& pair : cnt) {
+            ids.push_back(pair.first.get_raw());
+        }
+        std::sort(ids.begin(), ids.end());
+        for (auto first = ids.begin(); first != ids.end(); ) {
+            auto last = std::upper_bound(first, ids.end(), *first);
+            index.assign(*first, *this, last - first);
+            first = last;
+        }
+    }
+
+    namespace {
+        // sorts before any key of the @id: a live key goes before the expired one
+        struct form_key {
+            FormId id;
+            FormId get_raw() const { return id; }
+            bool is_expired() const { return false; }
+        };
+    }
+
+    bool form_map::u_has_form(FormId id) const {
+        auto itr = cnt.lower_bound(form_key{ id });
+        return itr != cnt.end() && itr->first.get_raw() == id;
+    }
+
+    size_t form_map::u_erase_form(FormId id) {
+        size_t erased = 0;
+        for (auto itr = cnt.lower_bound(form_key{ id }); itr != cnt.end() && itr->first.get_raw() == id; ++erased) {
+            u_key_removed(itr->first);
+            itr = cnt.erase(itr);
+        }
+        return erased;
+    }
+
     //////////////////////////////////////////////////////////////////////////
 
     void array::u_nullifyObjects() {
@@ -164,5 +314,21 @@ namespace collections {
         }
     }
 
+    void array::u_unpack() {
+        switch (_layout) {
+        case layout::ints:
+            _array.assign(_ints.begin(), _ints.end());
+            ints_type().swap(_ints);
+            break;
+        case layout::floats:
+            _array.assign(_floats.begin(), _floats.end());
+            floats_type().swap(_floats);
+            break;
+        default:
+            return;
+        }
+        _layout = layout::items;
+    }
+
     //////////////////////////////////////////////////////////////////////////
 }
@@ -7,12 +7,10 @@
 #include <boost/serialization/split_member.hpp>
 #include <boost/optional.hpp>
 
-#include "common/ITypes.h"
-#include "common/IDebugLog.h"
-#include "skse64/GameForms.h"
 #include "skse/skse.h"
 
 #include "object/object_base.h"
+#include "util/string_pool.h"
 
 #include "collections/item.h"
 
@@ -38,8 +36,8 @@ namespace collections {
         object_base& base() { return *this; }
         const object_base& base() const { return *this; }
 
-        typedef typename object_stack_ref_template<T> ref;
-        typedef typename object_stack_ref_template<const T> cref;
+        typedef object_stack_ref_template<T> ref;
+        typedef object_stack_ref_template<const T> cref;
 
         static T& make(object_context& context /*= tes_context::instance()*/) {
             auto& obj = *new T();
@@ -49,7 +47,7 @@ namespace collections {
         }
 
         template<class Init>
-        static T& _makeWithInitializer(Init& init, object_context& context /*= tes_context::instance()*/) {
+        static T& _makeWithInitializer(Init&& init, object_context& context /*= tes_context::instance()*/) {
             auto& obj = *new T();
             obj.set_context(context);
             init(obj);
@@ -62,50 +60,11 @@ namespace collections {
         }
 
         template<class Init>
-        static T& objectWithInitializer(Init& init, object_context& context /*= tes_context::instance()*/) {
+        static T& objectWithInitializer(Init&& init, object_context& context /*= tes_context::instance()*/) {
             return _makeWithInitializer(init, context);
         }
     };
 
-    template<class R, class Collection, class F, class ...Args>
-    inline R perform_on_object_and_return(Collection& container, F&& func, Args&&... args) {
-        switch (container.type()) {
-        case array::TypeId:
-            return func(container.as_link<array>(), std::forward<Args>(args)...);
-        case map::TypeId:
-            return func(container.as_link<map>(), std::forward<Args>(args)...);
-        case form_map::TypeId:
-            return func(container.as_link<form_map>(), std::forward<Args>(args)...);
-        case integer_map::TypeId:
-            return func(container.as_link<integer_map>(), std::forward<Args>(args)...);
-        default:
-            assert(false);
-            noreturn_func();
-            break;
-        }
-    }
-
-    template<class F, class Collection, class ...Args>
-    inline void perform_on_object(Collection& container, F&& func, Args&&... args) {
-        switch (container.type()) {
-        case array::TypeId:
-            func(container.as_link<array>(), std::forward<Args>(args)...);
-            break;
-        case map::TypeId:
-            func(container.as_link<map>(), std::forward<Args>(args)...);
-            break;
-        case form_map::TypeId:
-            func(container.as_link<form_map>(), std::forward<Args>(args)...);
-            break;
-        case integer_map::TypeId:
-            func(container.as_link<integer_map>(), std::forward<Args>(args)...);
-            break;
-        default:
-            assert(false);
-            break;
-        }
-    }
-
     class array;
     class map;
     class object_base;
@@ -130,19 +89,143 @@ namespace collections {
         typedef container_type::iterator iterator;
         typedef container_type::reverse_iterator reverse_iterator;
 
+        /// Storage layout. Arrays made by JIntArray/JFltArray keep homogeneous numbers packed.
+        /// Any access to the items (u_container, u_get, iterators) unpacks them for good
+        enum class layout : uint8_t {
+            items,
+            ints,
+            floats,
+        };
+
+        typedef std::vector<int32_t> ints_type;
+        typedef std::vector<float> floats_type;
+
+    private:
         container_type _array;
+        ints_type _ints;
+        floats_type _floats;
+        layout _layout = layout::items;
 
-        container_type& u_container() {
-            return _array;
+    public:
+
+        layout u_layout() const { return _layout; }
+
+        /// Only an empty array can be packed
+        void u_set_layout(layout l) {
+            jc_assert(u_count() == 0);
+            _layout = l;
         }
 
-        const container_type& u_container() const {
+        ints_type* u_ints() { return _layout == layout::ints ? &_ints : nullptr; }
+        const ints_type* u_ints() const { return _layout == layout::ints ? &_ints : nullptr; }
+
+        floats_type* u_floats() { return _layout == layout::floats ? &_floats : nullptr; }
+        const floats_type* u_floats() const { return _layout == layout::floats ? &_floats : nullptr; }
+
+        template<class T>
+        static constexpr bool is_packable = std::is_same<T, SInt32>::value || std::is_same<T, Float32>::value;
+
+        /// Packed storage of @T values, nullptr if the array is not packed with @T
+        template<class T> auto u_packed() {
+            static_assert(is_packable<T>, "only SInt32 and Float32 values get packed");
+            if constexpr (std::is_same<T, SInt32>::value) {
+                return u_ints();
+            }
+            else {
+                return u_floats();
+            }
+        }
+
+        /// Converts the packed numbers into generic items
+        void u_unpack();
+
+        /// Calls @func with the item at the (already converted) index. A packed number is passed
+        /// as a temporary item, so the array stays packed
+        template<class F> void u_read_at(uint32_t idx, F&& func) const {
+            switch (_layout) {
+            case layout::ints:
+                func(item(_ints[idx]));
+                break;
+            case layout::floats:
+                func(item(_floats[idx]));
+                break;
+            default:
+                func(_array[idx]);
+                break;
+            }
+        }
+
+        /// Packed writes: succeed only if the value matches the layout, otherwise the caller
+        /// falls back to u_container() which unpacks the array
+        template<class T> bool u_try_set_packed(uint32_t, const T&) { return false; }
+        bool u_try_set_packed(uint32_t idx, SInt32 value) {
+            if (auto ints = u_ints()) {
+                (*ints)[idx] = value;
+                return true;
+            }
+            return false;
+        }
+        bool u_try_set_packed(uint32_t idx, Float32 value) {
+            if (auto floats = u_floats()) {
+                (*floats)[idx] = value;
+                return true;
+            }
+            return false;
+        }
+
+        template<class T> bool u_try_insert_packed(uint32_t, const T&) { return false; }
+        bool u_try_insert_packed(uint32_t idx, SInt32 value) {
+            if (auto ints = u_ints()) {
+                ints->insert(ints->begin() + idx, value);
+                return true;
+            }
+            return false;
+        }
+        bool u_try_insert_packed(uint32_t idx, Float32 value) {
+            if (auto floats = u_floats()) {
+                floats->insert(floats->begin() + idx, value);
+                return true;
+            }
+            return false;
+        }
+
+        /// Erases [first, last) range without unpacking
+        void u_erase_range(uint32_t first, uint32_t last) {
+            switch (_layout) {
+            case layout::ints:
+                _ints.erase(_ints.begin() + first, _ints.begin() + last);
+                break;
+            case layout::floats:
+                _floats.erase(_floats.begin() + first, _floats.begin() + last);
+                break;
+            default:
+                _array.erase(_array.begin() + first, _array.begin() + last);
+                break;
+            }
+        }
+
+        /// Copies the items keeping the layout of @other
+        void u_assign(const array& other) {
+            _layout = other._layout;
+            _array = other._array;
+            _ints = other._ints;
+            _floats = other._floats;
+        }
+
+        /// Unpacks the packed numbers: the const readers use u_read_at instead
+        container_type& u_container() {
+            u_unpack();
             return _array;
         }
 
         container_type container_copy() const {
-            object_lock g(this);
-            return _array;
+            object_read_lock g(this);
+            container_type copy;
+            copy.reserve(u_count());
+            for (uint32_t i = 0, count = u_count(); i < count; ++i) {
+                u_read_at(i, [&copy](const item& itm) { copy.push_back(itm); });
+            }
+            return copy;
         }
 
         template<class T> void push(T&& item) {
@@ -151,21 +234,30 @@ namespace collections {
         }
 
         template<class T> void u_push(T&& item) {
-            _array.emplace_back(std::forward<T>(item));
+            u_container().emplace_back(std::forward<T>(item));
         }
 
         void u_clear() override {
             _array.clear();
+            _ints.clear();
+            _floats.clear();
         }
 
         SInt32 u_count() const override {
-            return _array.size();
+            switch (_layout) {
+            case layout::ints:
+                return _ints.size();
+            case layout::floats:
+                return _floats.size();
+            default:
+                return _array.size();
+            }
         }
 
         void u_nullifyObjects() override;
 
         void u_visit_referenced_objects(const std::function<void(object_base&)>& visitor) override {
-            for (auto& item : _array) {
+            for (auto& item : _array) { // packed numbers do not reference anything
                 if (auto obj = item.object()) {
                     visitor(*obj);
                 }
@@ -175,24 +267,21 @@ namespace collections {
         //////////////////////////////////////////////////////////////////////////
 
         boost::optional<int32_t> u_convertIndex(int32_t pyIndex) const {
-            int32_t count = (int32_t)_array.size();
+            int32_t count = u_count();
             int32_t index = (pyIndex >= 0 ? pyIndex : (count + pyIndex));
             return{ index >= 0 && index < count, index };
         }
 
-        const item* u_get(int32_t index) const {
-            auto idx = u_convertIndex(index);
-            return idx ? &_array[*idx] : nullptr;
-        }
-
         item* u_get(int32_t index) {
-            return const_cast<item*>( const_cast<const array*>(this)->u_get(index) );
+            auto idx = u_convertIndex(index);
+            return idx ? &u_container()[*idx] : nullptr;
         }
 
         bool u_erase(int32_t index) {
             auto idx = u_convertIndex(index);
             if (idx) {
-                _array.erase(_array.begin() + *idx);
+                auto& items = u_container();
+                items.erase(items.begin() + *idx);
                 return true;
             }
             return false;
@@ -202,7 +291,7 @@ namespace collections {
         item* u_set(int32_t index, T&& itm) {
             auto idx = u_convertIndex(index);
             if (idx) {
-                return &(_array[*idx] = std::forward<T>(itm));
+                return &(u_container()[*idx] = std::forward<T>(itm));
             }
             return nullptr;
         }
@@ -213,29 +302,26 @@ namespace collections {
             u_set(index, std::forward<T>(itm));
         }
 
-        template<class T>
-        static boost::optional<T> _opt_from_pointer(const T* t) {
-            return t ? boost::optional<T>(*t) : boost::none;
-        }
-
-        item& operator [] (int32_t index) { return const_cast<item&>(const_cast<const array*>(this)->operator[](index)); }
-        const item& operator [] (int32_t index) const {
+        item& operator [] (int32_t index) {
             auto idx = u_convertIndex(index);
             assert(idx);
-            return _array[*idx];
+            return u_container()[*idx];
         }
 
         boost::optional<item> get_item(int32_t index) const {
-            object_lock lock(this);
-            return _opt_from_pointer(u_get(index));
+            object_read_lock lock(this);
+            boost::optional<item> result;
+            if (auto idx = u_convertIndex(index)) {
+                u_read_at(*idx, [&result](const item& itm) { result = itm; });
+            }
+            return result;
         }
 
-        iterator begin() { return _array.begin();}
-        iterator end() { return _array.end(); }
-
-        reverse_iterator rbegin() { return _array.rbegin();}
-        reverse_iterator rend() { return _array.rend(); }
+        iterator begin() { return u_container().begin();}
+        iterator end() { return u_container().end(); }
 
+        reverse_iterator rbegin() { return u_container().rbegin();}
+        reverse_iterator rend() { return u_container().rend(); }
 
         //////////////////////////////////////////////////////////////////////////
 
@@ -254,8 +340,8 @@ namespace collections {
     protected:
         ContainerType cnt;
 
-        template<class ContainerType>
-        static util::choose_iterator<ContainerType> _find(ContainerType& c, const key_type& k) { return c.find(k); }
+        template<class C>
+        static util::choose_iterator<C> _find(C& c, const key_type& k) { return c.find(k); }
 
     public:
 
@@ -268,28 +354,45 @@ namespace collections {
         }
 
         container_type container_copy() const {
-            object_lock g(this);
+            object_read_lock g(this);
             return cnt;
         }
 
         template<class Key>
         item findOrDef(const Key& key) const {
-            object_lock g(this);
+            object_read_lock g(this);
             auto result = u_get(key);
             return result ? *result : item();
         }
 
         template<class Key>
         boost::optional<item> get_item(const Key& key) const {
-            object_lock g(this);
+            object_read_lock g(this);
             auto result = u_get(key);
             return result ? *result : boost::optional<item>();
         }
 
         item& u_get_or_create(const key_type& key) {
-            return cnt[key];
+            auto inserted = cnt.try_emplace(key);
+            if (inserted.second) {
+                static_cast<RealType*>(this)->u_key_added(inserted.first->first);
+            }
+            return inserted.first->second;
+        }
+
+        /// Inserts the @pair unless the key is present already
+        bool u_insert(const value_type& pair) {
+            auto inserted = cnt.insert(pair);
+            if (inserted.second) {
+                static_cast<RealType*>(this)->u_key_added(inserted.first->first);
+            }
+            return inserted.second;
         }
 
+        // Called for each key the container gains or loses (form_map maintains the form_map_index, map drops the JDB root snapshot)
+        void u_key_added(const key_type&) {}
+        void u_key_removed(const key_type&) {}
+
         template<class Key>
         const item* u_get(const Key& key) const {
             auto itr = RealType::_find(cnt, key);
@@ -313,7 +416,12 @@ namespace collections {
         template<class Key>
         bool u_erase(const Key& key) {
             typename container_type::iterator itr = RealType::_find(cnt, key);
-            return itr != cnt.end() ? (cnt.erase(itr), true) : false;
+            if (itr == cnt.end()) {
+                return false;
+            }
+            static_cast<RealType*>(this)->u_key_removed(itr->first);
+            cnt.erase(itr);
+            return true;
         }
 
         void u_clear() override {
@@ -321,7 +429,7 @@ namespace collections {
         }
 
         template<class T, class Key> item* u_set(const Key& key, T&& value) {
-            return &(cnt[key] = std::forward<T>(value));
+            return &(static_cast<RealType*>(this)->u_get_or_create(key) = std::forward<T>(value));
         }
 
         template<class T, class Key> void set(const Key& key, T&& value) {
@@ -360,24 +468,79 @@ namespace collections {
         }
     };
 
-    struct map_case_insensitive_comp {
-        bool operator() (const std::string& lhs, const std::string& rhs) const {
-            return _stricmp(lhs.c_str(), rhs.c_str()) < 0;
-        }
-    };
-
+    // Keys are interned: equal keys share the memory and the case-folded spelling
+    using map_case_insensitive_comp = util::interned_string_case_insensitive_less;
 
-    class map : public basic_map_collection< map, std::map<std::string, item, map_case_insensitive_comp > >
+    class map : public basic_map_collection< map, std::map<util::interned_string, item, map_case_insensitive_comp > >
     {
+    private:
+        using base = basic_map_collection< map, std::map<util::interned_string, item, map_case_insensitive_comp > >;
+
     public:
         enum  {
             TypeId = CollectionType::Map,
         };
 
+        // Plain string lookups fold and hash the key once and don't touch the string pool
+
+        using base::_find;
+
+        template<class ContainerType>
+        static util::choose_iterator<ContainerType> _find(ContainerType& c, const util::folded_key& k) {
+            auto itr = c.lower_bound(k);
+            return (itr != c.end() && map_case_insensitive_comp::equals(itr->first, k)) ? itr : c.end();
+        }
+
+        template<class ContainerType>
+        static util::choose_iterator<ContainerType> _find(ContainerType& c, const char* k) {
+            return _find(c, util::folded_key(k));
+        }
+
+        template<class ContainerType>
+        static util::choose_iterator<ContainerType> _find(ContainerType& c, const std::string& k) {
+            return _find(c, util::folded_key(k));
+        }
+
+        item& u_get_or_create(const key_type& key) {
+            u_changed();
+            return base::u_get_or_create(key);
+        }
+
+        item& u_get_or_create(const char* key) {
+            return u_get_or_create(std::string_view(key ? key : ""));
+        }
+
+        item& u_get_or_create(const std::string& key) {
+            return u_get_or_create(std::string_view(key));
+        }
+
+        item& u_get_or_create(std::string_view key) {
+            u_changed();
+            util::folded_key k(key);
+            auto itr = cnt.lower_bound(k);
+            if (itr != cnt.end() && map_case_insensitive_comp::equals(itr->first, k)) {
+                return itr->second;
+            }
+            return cnt.emplace_hint(itr, util::interned_string(key), item())->second;
+        }
+
+        /// Tells the JDB root snapshot that the values may change: a key gets added or removed, or a value
+        /// gets written in place. Every writer calls it under the map's lock, the returned item pointers included
+        void u_changed();
+
+        void u_key_added(const util::interned_string&) { u_changed(); }
+        void u_key_removed(const util::interned_string&) { u_changed(); }
+        void u_clear() override;
+
         //////////////////////////////////////////////////////////////////////////
 
+        friend class boost::serialization::access;
+        BOOST_SERIALIZATION_SPLIT_MEMBER();
+
         template<class Archive>
-        void serialize(Archive & ar, const unsigned int version);
+        void load(Archive & ar, const unsigned int version);
+        template<class Archive>
+        void save(Archive & ar, const unsigned int version) const;
     };
 
     class form_map : public basic_map_collection< form_map, std::map<form_ref, item, form_ref::stable_less_comparer> >
@@ -404,7 +567,7 @@ namespace collections {
         }
 
         item& u_get_or_create(const form_ref_lightweight& key) {
-            return cnt[key.to_form_ref()];
+            return u_get_or_create(key.to_form_ref());
         }
 
     public:
@@ -412,7 +575,23 @@ namespace collections {
             TypeId = CollectionType::FormMap,
         };
 
+        ~form_map();
+
         void u_onLoaded() override;
+        void u_clear() override;
+
+        void u_assign(const form_map& other);
+
+        // form_map_index support
+
+        void u_key_added(const form_ref& key);
+        void u_key_removed(const form_ref& key);
+        void u_index_keys();
+
+        /// Whether any key (the expired one too) is of the @id
+        bool u_has_form(FormId id) const;
+        /// Erases the keys of the @id, the expired one too. Returns the count of erased keys
+        size_t u_erase_form(FormId id);
 
         //////////////////////////////////////////////////////////////////////////
 
@@ -435,4 +614,43 @@ namespace collections {
         template<class Archive>
         void serialize(Archive & ar, const unsigned int version);
     };
+
+    template<class R, class Collection, class F, class ...Args>
+    inline R perform_on_object_and_return(Collection& container, F&& func, Args&&... args) {
+        switch (container.type()) {
+        case array::TypeId:
+            return func(container.template as_link<array>(), std::forward<Args>(args)...);
+        case map::TypeId:
+            return func(container.template as_link<map>(), std::forward<Args>(args)...);
+        case form_map::TypeId:
+            return func(container.template as_link<form_map>(), std::forward<Args>(args)...);
+        case integer_map::TypeId:
+            return func(container.template as_link<integer_map>(), std::forward<Args>(args)...);
+        default:
+            assert(false);
+            noreturn_func();
+            break;
+        }
+    }
+
+    template<class F, class Collection, class ...Args>
+    inline void perform_on_object(Collection& container, F&& func, Args&&... args) {
+        switch (container.type()) {
+        case array::TypeId:
+            func(container.template as_link<array>(), std::forward<Args>(args)...);
+            break;
+        case map::TypeId:
+            func(container.template as_link<map>(), std::forward<Args>(args)...);
+            break;
+        case form_map::TypeId:
+            func(container.template as_link<form_map>(), std::forward<Args>(args)...);
+            break;
+        case integer_map::TypeId:
+            func(container.template as_link<integer_map>(), std::forward<Args>(args)...);
+            break;
+        default:
+            assert(false);
+            break;
+        }
+    }
 }
@@ -9,6 +9,8 @@
 
 #include "forms/form_observer.h"
 #include "collections/collections.h"
+#include "collections/form_map_index.h"
+#include "collections/root_snapshot.h"
 
 namespace collections
 {
@@ -68,6 +70,23 @@ namespace collections
 
         forms::form_observer& _form_watcher;
 
+        // form id -> the JFormMaps having the form as a key
+        form_map_index _form_map_index;
+
+        /// The JFormMaps having a key (the expired one too) of the @form. The first call indexes all existing JFormMaps,
+        /// the later ones take the time proportional to the count of the maps found
+        std::vector<form_map::ref> form_maps_with(FormId form);
+
+        // JDB top-level keys, read without the root lock
+        root_snapshot _root_snapshot;
+
+        /// The JDB top-level keys and values as of now or a moment ago. Locks the root only if it has changed since the last call
+        root_snapshot::version_ref root_keys();
+
+        /// The JFormDB storage: the JFormMap at the @storage_name key of the JDB, null if none. The reference keeps the map
+        /// alive: a concurrent JDB write may replace it and drop the snapshot version it has been found in
+        form_map::ref form_storage(const char* storage_name);
+
         //////
     public:
 
@@ -94,6 +113,8 @@ namespace collections
             _root_object_id.store(Handle::Null, std::memory_order_relaxed);
             _cached_root = nullptr;
             //_form_watcher.u_clearState();
+            _form_map_index.u_clear(); // the maps get deleted below, no need to unindex them one by one
+            _root_snapshot.reset(nullptr); // before its items get deleted
 
             base::u_clearState();
         }
@@ -63,7 +63,7 @@ namespace collections {
 
     void tes_context::read_from_stream(std::istream & stream) {
 
-        stream.flags(stream.flags() | std::ios::binary);
+        stream.flags(stream.flags() | static_cast<std::ios::fmtflags>(std::ios::binary));
 
 #       if 0
         std::ofstream file("dump", std::ios::binary | std::ios::out);
@@ -135,7 +135,7 @@ namespace collections {
 
     void tes_context::write_to_stream(std::ostream& stream) {
 
-        stream.flags(stream.flags() | std::ios::binary);
+        stream.flags(stream.flags() | static_cast<std::ios::fmtflags>(std::ios::binary));
 
         activity_stopper s{ *this };
         {
@@ -200,6 +200,49 @@ namespace collections {
 
     ////////////////////////
 
+    std::vector<form_map::ref> tes_context::form_maps_with(FormId form) {
+        _form_map_index.ensure_ready([this]() {
+            for (auto& obj : filter_objects([](object_base& obj) { return obj.as<form_map>() != nullptr; })) {
+                object_lock g(obj);
+                obj->as<form_map>()->u_index_keys();
+            }
+        });
+
+        std::vector<form_map::ref> found;
+        // out of the index lock: the registry lock comes first, a map may get deleted (and unindex itself) under it
+        for (auto fmap : _form_map_index.maps_with(form)) {
+            // a registered object is alive, but the address of a deleted map may have been reused meanwhile
+            auto alive = getObjectRef(fmap);
+            if (alive && alive->as<form_map>()) {
+                found.push_back(fmap);
+            }
+        }
+        return found;
+    }
+
+    root_snapshot::version_ref tes_context::root_keys() {
+        if (auto keys = _root_snapshot.current()) {
+            return keys;
+        }
+        map& db = root();
+        object_read_lock g(db);
+        return _root_snapshot.u_publish(db);
+    }
+
+    form_map::ref tes_context::form_storage(const char* storage_name) {
+        if (!storage_name || !*storage_name) {
+            return nullptr;
+        }
+
+        // retained while the version, whose item holds the map, is alive
+        auto keys = root_keys();
+        const item* value = keys->find(util::folded_key(storage_name));
+        auto obj = value ? value->object() : nullptr;
+        return obj ? obj->as<form_map>() : nullptr;
+    }
+
+    ////////////////////////
+
     void tes_context::shutdown() {
         stop_activity();
         u_clearState();
@@ -230,6 +273,8 @@ namespace collections {
         }
 
         _root_object_id.store(db ? db->uid() : Handle::Null, std::memory_order_relaxed);
+        _cached_root.store(db ? db->as<map>() : nullptr, std::memory_order_release); // root() would return the released one
+        _root_snapshot.reset(db ? db->as<map>() : nullptr);
     }
 
     map& tes_context::root()
@@ -246,6 +291,9 @@ namespace collections {
                     result = &map::object(*this);
                     set_root(result);
                 }
+                else {
+                    _root_snapshot.reset(result); // a loaded root
+                }
 
                 _cached_root.store(result, std::memory_order_release);
             }
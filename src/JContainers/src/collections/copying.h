@@ -27,6 +27,22 @@ namespace collections {
                 },
                     *_context);
             }
+
+            object_base& operator () (const form_map& origin) const {
+                return form_map::objectWithInitializer([&](form_map& self) {
+                    object_lock lock(origin);
+                    self.u_assign(origin);
+                },
+                    *_context);
+            }
+
+            object_base& operator () (const array& origin) const {
+                return array::objectWithInitializer([&](array& self) {
+                    object_lock lock(origin);
+                    self.u_assign(origin);
+                },
+                    *_context);
+            }
         };
 
     public:
@@ -75,6 +91,9 @@ namespace collections {
             copying *const self;
             void operator () (array& ar) {
                 object_lock lock(ar);
+                if (ar.u_layout() != array::layout::items) {
+                    return; // packed numbers, nothing to copy
+                }
                 for (auto& itm : ar.u_container()) {
                     copy_child(itm);
                 }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "util/spinlock.h"
+#include "forms/form_id.h"
+
+namespace collections {
+
+    using forms::FormId;
+
+    class form_map;
+
+    /**
+     * Form id -> the JFormMaps having the form as a key (a map is listed once per key of the form: the expired key
+     * and the live one). Off until the first lookup turns it on. While it's on, a form_map reports each key it gains
+     * or loses, under its own lock.
+     */
+    class form_map_index {
+
+        std::atomic<bool> _enabled{ false };
+        std::atomic<bool> _ready{ false };  // enabled and the maps which existed before have been indexed
+        std::mutex _enable_mutex;
+        mutable util::spinlock _lock;
+        std::unordered_map<FormId, std::vector<form_map*>> _maps;
+
+    public:
+
+        bool enabled() const { return _enabled.load(std::memory_order_acquire); }
+
+        /// Turns the index on (the maps index their new keys from now on), then calls @index_existing_maps() once.
+        /// A map may report a key before @index_existing_maps() reaches it, so the latter has to use assign(), not add()
+        template<class F>
+        void ensure_ready(F&& index_existing_maps) {
+            if (_ready.load(std::memory_order_acquire)) {
+                return;
+            }
+            std::lock_guard<std::mutex> g{ _enable_mutex };
+            if (!_ready.load(std::memory_order_relaxed)) {
+                _enabled.store(true, std::memory_order_release);
+                index_existing_maps();
+                _ready.store(true, std::memory_order_release);
+            }
+        }
+
+        void add(FormId id, form_map& fmap) {
+            if (id == FormId::Zero) {
+                return;
+            }
+            util::spinlock::guard g{ _lock };
+            _maps[id].push_back(&fmap);
+        }
+
+        /// Lists the @fmap exactly @count times for the @id (the count of its keys of the @id), whatever it reported before
+        void assign(FormId id, form_map& fmap, size_t count) {
+            if (id == FormId::Zero) {
+                return;
+            }
+            util::spinlock::guard g{ _lock };
+            auto& maps = _maps[id];
+            auto listed = (size_t)std::count(maps.begin(), maps.end(), &fmap);
+            for (; listed < count; ++listed) {
+                maps.push_back(&fmap);
+            }
+            for (auto itr = maps.begin(); listed > count; ) {
+                if (*itr == &fmap) {
+                    *itr = maps.back();
+                    maps.pop_back();
+                    --listed;
+                }
+                else {
+                    ++itr;
+                }
+            }
+            if (maps.empty()) {
+                _maps.erase(id);
+            }
+        }
+
+        void remove(FormId id, form_map& fmap) {
+            util::spinlock::guard g{ _lock };
+            auto itr = _maps.find(id);
+            if (itr == _maps.end()) {
+                return;
+            }
+            auto& maps = itr->second;
+            auto found = std::find(maps.begin(), maps.end(), &fmap);
+            if (found != maps.end()) {
+                *found = maps.back();
+                maps.pop_back();
+            }
+            if (maps.empty()) {
+                _maps.erase(itr);
+            }
+        }
+
+        /// The distinct maps of the @id, copied out of the lock: they may be dead by the time the caller looks at them
+        std::vector<form_map*> maps_with(FormId id) const {
+            std::vector<form_map*> maps;
+            {
+                util::spinlock::guard g{ _lock };
+                auto itr = _maps.find(id);
+                if (itr == _maps.end()) {
+                    return maps;
+                }
+                maps = itr->second;
+            }
+            std::sort(maps.begin(), maps.end());
+            maps.erase(std::unique(maps.begin(), maps.end()), maps.end());
+            return maps;
+        }
+
+        size_t u_form_count() const { return _maps.size(); }
+
+        void u_clear() {
+            _ready.store(false, std::memory_order_relaxed);
+            _enabled.store(false, std::memory_order_release);
+            _maps.clear();
+        }
+    };
+}
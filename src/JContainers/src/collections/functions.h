@@ -112,7 +112,7 @@ namespace collections {
         template<class Op, class R,/* class RAlter, */class key_type>
         static R doReadOpR(T * obj, const key_type& key, R default, Op& operation) {
             if (obj && key_checker::check(key)) {
-                object_lock g(obj);
+                object_read_lock g(obj);
                 item *itm = obj->u_get(key);
                 return itm ? operation(*itm) : default;
             }
@@ -124,7 +124,7 @@ namespace collections {
         template<class Op, class key_type>
         static void doReadOp(T * obj, const key_type& key, Op& operation) {
             if (obj && key_checker::check(key)) {
-                object_lock g(obj);
+                object_read_lock g(obj);
                 item *itm = obj->u_get(key);
                 if (itm) {
                     operation(*itm);
@@ -145,10 +145,10 @@ namespace collections {
         template<class KeyFunc, class KeyTypeIn>
         static void nextKey(const T *obj, const KeyTypeIn& lastKey, KeyFunc keyFunc) {
             if (obj) {
-                object_lock g(obj);
+                object_read_lock g(obj);
                 auto& container = obj->u_container();
                 if (key_checker::check(lastKey)) {
-                    auto itr = container.find(lastKey);
+                    auto itr = obj->u_find_iterator(lastKey);
                     auto end = container.end();
                     if (itr != end && (++itr) != end) {
                         keyFunc(itr->first);
@@ -172,7 +172,7 @@ namespace collections {
             const KeyTypeIn& endKey, const KeyComparer key_equality = equal_to{})
         {
             if (obj) {
-                object_lock g(obj);
+                object_read_lock g(obj);
                 auto& container = obj->u_container();
 
                 if (container.empty()) {
@@ -212,7 +212,7 @@ namespace collections {
         template<class KeyFunc>
         static void getNthKey(const T *obj, int32_t keyIdx, KeyFunc keyFunc) {
             if (obj) {
-                object_lock g(obj);
+                object_read_lock g(obj);
                 auto idx = array_functions::convertReadIndex(obj, keyIdx);
                 if (idx) {
                     int32_t count = obj->u_count();
@@ -2,13 +2,13 @@
 
 #include <boost/variant.hpp>
 #include <string>
-#include <xutility>
+#include <utility>
 #include <boost/serialization/access.hpp>
 
-#include "common/ITypes.h"
 #include "object/object_base.h"
 #include "skse/skse.h"
 #include "skse/string.h"
+#include "util/string_pool.h"
 
 #include "forms/form_id.h"
 #include "forms/form_observer.h"
@@ -29,6 +29,38 @@ namespace collections {
 
     using ::forms::FormId;
 
+    // the type traits of the item below, at namespace scope as a class can't hold explicit specializations in standard C++
+    namespace detail {
+
+        template<class T> struct item_type2index{ };
+
+        template<> struct item_type2index < boost::blank >  { static const item_type index = none; };
+        template<> struct item_type2index < SInt32 >  { static const item_type index = integer; };
+        template<> struct item_type2index < Float32 >  { static const item_type index = real; };
+        template<> struct item_type2index < form_ref >  { static const item_type index = form; };
+        template<> struct item_type2index < internal_object_ref >  { static const item_type index = object; };
+        template<> struct item_type2index < std::string >  { static const item_type index = string; };
+
+        // maps input user type to variant type:
+        template<class T> struct item_user2variant { using variant_type = T; };
+        template<class V> struct item_variant_type { using variant_type = V; };
+
+        template<> struct item_user2variant<uint32_t> : item_variant_type<SInt32>{};
+        template<> struct item_user2variant<int32_t> : item_variant_type<SInt32>{};
+        template<> struct item_user2variant<bool> : item_variant_type<SInt32>{};
+
+        template<> struct item_user2variant<float> : item_variant_type<Float32>{};
+        template<> struct item_user2variant<double> : item_variant_type<Float32>{};
+
+        template<> struct item_user2variant<skse::string_ref> : item_variant_type<std::string>{};
+        template<> struct item_user2variant<char*> : item_variant_type<std::string>{};
+        template<size_t N> struct item_user2variant<char[N]> : item_variant_type<std::string>{};
+        template<> struct item_user2variant<char[]> : item_variant_type<std::string>{};
+
+        template<> struct item_user2variant<object_base*> : item_variant_type<internal_object_ref>{};
+        template<> struct item_user2variant<const object_base*> : item_variant_type<internal_object_ref>{};
+    }
+
     class item {
     public:
         typedef boost::blank blank;
@@ -40,14 +72,7 @@ namespace collections {
 
     private:
 
-        template<class T> struct type2index{ };
-
-        template<> struct type2index < boost::blank >  { static const item_type index = none; };
-        template<> struct type2index < SInt32 >  { static const item_type index = integer; };
-        template<> struct type2index < Real >  { static const item_type index = real; };
-        template<> struct type2index < form_ref >  { static const item_type index = form; };
-        template<> struct type2index < internal_object_ref >  { static const item_type index = object; };
-        template<> struct type2index < std::string >  { static const item_type index = string; };
+        template<class T> using type2index = detail::item_type2index<T>;
 
         static_assert(type2index<Real>::index > type2index<SInt32>::index, "Item::type2index works incorrectly");
 
@@ -55,30 +80,11 @@ namespace collections {
         static_assert(std::is_same<
             boost::variant<boost::blank, SInt32, Real, form_ref, internal_object_ref, std::string>,
             variant
-        >::value, "update _user2variant code below");
-
-        // maps input user type to variant type:
-        template<class T> struct _user2variant { using variant_type = T; };
-        template<class V> struct _variant_type { using variant_type = V; };
-
-        template<> struct _user2variant<uint32_t> : _variant_type<SInt32>{};
-        template<> struct _user2variant<int32_t> : _variant_type<SInt32>{};
-        template<> struct _user2variant<bool> : _variant_type<SInt32>{};
-
-        template<> struct _user2variant<float> : _variant_type<Real>{};
-        template<> struct _user2variant<double> : _variant_type<Real>{};
-
-        template<> struct _user2variant<skse::string_ref> : _variant_type<std::string>{};
-        template<> struct _user2variant<char*> : _variant_type<std::string>{};
-        template<size_t N> struct _user2variant<char[N]> : _variant_type<std::string>{};
-        template<> struct _user2variant<char[]> : _variant_type<std::string>{};
-
-        template<> struct _user2variant<object_base*> : _variant_type<internal_object_ref>{};
-        template<> struct _user2variant<const object_base*> : _variant_type<internal_object_ref>{};
+        >::value, "update detail::item_user2variant code above");
 
     public:
         template<class T>
-        using user2variant_t = typename _user2variant<
+        using user2variant_t = typename detail::item_user2variant<
             std::remove_const_t< std::remove_reference_t<T> > >::variant_type;
 
     public:
@@ -142,7 +148,9 @@ namespace collections {
         explicit item(Real val) : _var(val) {}
         explicit item(double val) : _var((Real)val) {}
         explicit item(SInt32 val) : _var(val) {}
+#ifndef JC_CORE // SInt32 is a long in SKSE, the int below is another type
         explicit item(int val) : _var((SInt32)val) {}
+#endif
         explicit item(bool val) : _var((SInt32)val) {}
         explicit item(const form_ref& id) : _var(id) {}
         explicit item(form_ref&& id) : _var(std::move(id)) {}
@@ -151,6 +159,7 @@ namespace collections {
 
         explicit item(const std::string& val) : _var(val) {}
         explicit item(std::string&& val) : _var(std::move(val)) {}
+        explicit item(const util::interned_string& val) : _var(val.str()) {}
 
         // the Item is none if the pointers below are zero:
         explicit item(const char * val) {
@@ -169,11 +178,14 @@ namespace collections {
         item& operator = (unsigned int val) { _var = (SInt32)val; return *this; }
         item& operator = (int val) { _var = (SInt32)val; return *this; }
         item& operator = (bool val) { _var = (SInt32)val; return *this; }
+#ifndef JC_CORE
         item& operator = (SInt32 val) { _var = val; return *this; }
+#endif
         item& operator = (Real val) { _var = val; return *this; }
         item& operator = (double val) { _var = (Real)val; return *this; }
         item& operator = (const std::string& val) { _var = val; return *this; }
         item& operator = (std::string&& val) { _var = std::move(val); return *this; }
+        item& operator = (const util::interned_string& val) { _var = val.str(); return *this; }
         item& operator = (const skse::string_ref& val) { return *this = val.c_str(); }
         item& operator = (boost::blank) { _var = boost::blank(); return *this; }
         item& operator = (boost::none_t) { _var = boost::blank(); return *this; }
@@ -265,8 +277,8 @@ namespace collections {
                 return lhs == rhs;
             }
 
-            template <> bool operator()(const std::string & lhs, const std::string & rhs) const {
-                return _stricmp(lhs.c_str(), rhs.c_str()) == 0;
+            bool operator()(const std::string & lhs, const std::string & rhs) const {
+                return util::case_fold::equals(lhs, rhs);
             }
         };
 
@@ -320,7 +332,7 @@ namespace collections {
             }
 
             bool operator()(const std::string & lhs, const std::string & rhs) const {
-                return _stricmp(lhs.c_str(), rhs.c_str()) < 0;
+                return util::case_fold::compare(lhs, rhs) < 0;
             }
 
         };
@@ -160,7 +160,7 @@ namespace collections {
                 object_base *resolvedObject = nullptr;
 
                 if (path.empty() == false) {
-                    ca::visit_value(root, path.c_str(), ca::constant, [&resolvedObject](item& itm) {
+                    ca::read_value(root, path.c_str(), [&resolvedObject](const item& itm) {
                         resolvedObject = itm.object();
                     });
                 }
@@ -422,15 +422,16 @@ namespace collections {
                 json_ref object;
 
                 void operator () (const array& cnt) {
-                    size_t index = 0;
-                    for (auto& itm : cnt.u_container()) {
-                        self->fill_key_info(itm, cnt, index++);
-                        json_array_append_new(object, self->create_value(itm));
+                    for (size_t index = 0, count = cnt.u_count(); index < count; ++index) {
+                        cnt.u_read_at(index, [&](const item& itm) {
+                            self->fill_key_info(itm, cnt, index);
+                            json_array_append_new(object, self->create_value(itm));
+                        });
                     }
                 }
                 void operator () (const map& cnt) {
                     for (auto& pair : cnt.u_container()) {
-                        self->fill_key_info(pair.second, cnt, pair.first);
+                        self->fill_key_info(pair.second, cnt, pair.first.str());
                         json_object_set_new(object, pair.first.c_str(), self->create_value(pair.second));
                     }
                 }
@@ -12,7 +12,10 @@
 #include <sstream>
 #include <mutex>
 #include <algorithm>
+#include <memory>
 #include <thread>
+#include <unordered_map>
+#include <condition_variable>
 
 extern "C" {
 #include "lua.h"
@@ -53,10 +56,75 @@ namespace lua { namespace aux_wip {
 
     using namespace api;
 
+    // Compiled JValue.evalLua* chunks shared by all contexts of a pool: script text -> string.dump output.
+    // Survives clear_state, scripts stay the same between game loads
+    class bytecode_cache final : public boost::noncopyable {
+        static const size_t max_entries = 4096;
+
+        std::mutex _mutex;
+        std::unordered_map<std::string, std::string> _chunks;
+
+    public:
+
+        boost::optional<std::string> find(const std::string& script) {
+            std::lock_guard<std::mutex> g{ _mutex };
+            auto itr = _chunks.find(script);
+            return itr != _chunks.end() ? boost::make_optional(itr->second) : boost::none;
+        }
+
+        void insert(std::string script, std::string bytecode) {
+            std::lock_guard<std::mutex> g{ _mutex };
+            if (_chunks.size() >= max_entries) {
+                _chunks.clear(); // a mod generating scripts on the fly shouldn't eat all the memory
+            }
+            _chunks.emplace(std::move(script), std::move(bytecode));
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> g{ _mutex };
+            _chunks.clear();
+        }
+
+        // JC_loadCachedChunk(luaString) -> function or nil
+        static int lua_load_cached(lua_State *l) {
+            auto& self = *static_cast<bytecode_cache*>(lua_touserdata(l, lua_upvalueindex(1)));
+            size_t length = 0;
+            const char *script = luaL_checklstring(l, 1, &length);
+
+            auto bytecode = self.find(std::string(script, length));
+            if (!bytecode || luaL_loadbuffer(l, bytecode->data(), bytecode->size(), script) != LUA_OK) {
+                lua_pushnil(l);
+            }
+            return 1;
+        }
+
+        // JC_cacheChunk(luaString, string.dump(function))
+        static int lua_cache(lua_State *l) {
+            auto& self = *static_cast<bytecode_cache*>(lua_touserdata(l, lua_upvalueindex(1)));
+            size_t scriptLength = 0, bytecodeLength = 0;
+            const char *script = luaL_checklstring(l, 1, &scriptLength);
+            const char *bytecode = luaL_checklstring(l, 2, &bytecodeLength);
+
+            self.insert(std::string(script, scriptLength), std::string(bytecode, bytecodeLength));
+            return 0;
+        }
+
+        void register_functions(lua_State *l) {
+            lua_pushlightuserdata(l, this);
+            lua_pushcclosure(l, &lua_load_cached, 1);
+            lua_setglobal(l, "JC_loadCachedChunk");
+
+            lua_pushlightuserdata(l, this);
+            lua_pushcclosure(l, &lua_cache, 1);
+            lua_setglobal(l, "JC_cacheChunk");
+        }
+    };
+
     class context final : public boost::noncopyable {
 
         lua_State *_lua = nullptr;
         tes_context& _context;
+        bytecode_cache& _bytecode;
 
     public:
 
@@ -64,7 +132,7 @@ namespace lua { namespace aux_wip {
             return _lua;
         }
 
-        explicit context(tes_context& context) : _context(context) {
+        context(tes_context& context, bytecode_cache& bytecode) : _context(context), _bytecode(bytecode) {
             reopen_if_closed();
             JC_log("Lua context created");
         }
@@ -114,6 +182,7 @@ namespace lua { namespace aux_wip {
                 JC_log ("reopen_if_closed() timed out while trying to allocate LuaJIT memory; subsequent Lua operations may crash");
 
             luaL_openlibs (_lua);
+            _bytecode.register_functions (_lua);
             setupLuaContext (_lua, _context);
         }
 
@@ -187,34 +256,195 @@ namespace lua { namespace aux_wip {
     // just a pool, factory of contexts.
     // any thead can obtain free (or newly created), initialized lua-context
     // the tread have to return it back via @release
+    //
+    // Each thread gets a context of its own (bound on first release) and keeps reusing it,
+    // so Papyrus worker threads always find their caches warm. Other contexts are shared via the queue.
+    // The contexts of the exited threads are deleted on the next bind.
+    // Once @limits.max_contexts exist, a thread waits up to @limits.wait for a free one, then creates it anyway
     class context_pool final : public collections::dependent_context, boost::noncopyable {
         static const uint32_t queue_capacity = 16;
 
+        // a context bound to a thread, shared by the thread's slot and the pool. The state tells which side
+        // deletes the context when the thread exits or the pool gets cleared
+        struct binding {
+            enum state_t : uint8_t {
+                idle,
+                busy,
+                orphaned,   // the thread has exited, the pool deletes the context
+                doomed,     // the pool got cleared while the thread used it, the thread deletes it on release
+                dead,       // deleted or given away
+            };
+
+            context *const ctx;
+            std::atomic<uint8_t> state;
+
+            explicit binding(context& c) : ctx(&c), state(idle) {}
+        };
+
+        // the context bound to a thread, per pool
+        struct thread_slot : boost::noncopyable {
+            std::shared_ptr<binding> bound;
+
+            ~thread_slot() {
+                if (bound) {
+                    uint8_t expected = binding::idle;
+                    bound->state.compare_exchange_strong(expected, binding::orphaned);
+                }
+            }
+        };
+
+        static std::atomic<uint64_t> s_last_pool_id;
+        // pool id -> slot. The ids are never reused, so a slot of a dead pool is just never looked up again
+        static thread_local std::unordered_map<uint64_t, thread_slot> t_slots;
+
         boost::lockfree::queue<context*> _queue { queue_capacity };
         tes_context& _tcontext;
+        bytecode_cache _bytecode;
+        const uint64_t _id = ++s_last_pool_id;
+
         std::atomic_int32_t _aquired_count = 0;
+        std::atomic_int32_t _idle_count = 0;
+        std::atomic_int32_t _context_count = 0;
+
+        std::mutex _bound_mutex;
+        std::vector<std::shared_ptr<binding>> _bound;
+
+        std::atomic<uint32_t> _max_contexts = JC_LUA_MAX_CONTEXTS;
+        std::atomic<uint32_t> _wait_ms = JC_LUA_CONTEXT_WAIT_MS;
+        std::mutex _wait_mutex;
+        std::condition_variable _released;
+        std::atomic_int32_t _waiting = 0;
+
+        struct {
+            std::atomic<uint32_t> created = 0;
+            std::atomic<uint32_t> thread_hits = 0;
+            std::atomic<uint32_t> pool_hits = 0;
+            std::atomic<uint32_t> waits = 0;
+            std::atomic<uint32_t> over_limit = 0;
+            std::atomic<uint32_t> peak_concurrency = 0;
+            std::atomic<uint32_t> peak_contexts = 0;
+        } _stats;
+
+        // background creation of idle contexts, see @prewarm
+        std::mutex _prewarm_mutex;
+        std::thread _prewarmer;
+        std::atomic<uint32_t> _prewarm_size = 0;
+        std::atomic_bool _stop_prewarm = false;
 
     public:
 
         context& aquire() {
-            ++_aquired_count;
+            note_concurrency(++_aquired_count);
+
+            auto& slot = t_slots[_id];
+            if (slot.bound) {
+                uint8_t expected = binding::idle;
+                if (slot.bound->state.compare_exchange_strong(expected, binding::busy)) {
+                    ++_stats.thread_hits;
+                    return *slot.bound->ctx;
+                }
+                if (expected == binding::dead) {
+                    slot.bound.reset(); // the pool has been cleared. A doomed context waits for its release
+                }
+            }
 
             context *ctx = nullptr;
+            if (pop_idle(ctx)) {
+                ++_stats.pool_hits;
+                return *ctx;
+            }
 
-            if (!_queue.pop(ctx)) {
-                ctx = new context(_tcontext);
+            bool reserved = reserve_context();
+            if (!reserved && _wait_ms > 0) {
+                ++_stats.waits;
+                std::unique_lock<std::mutex> g{ _wait_mutex };
+                ++_waiting;
+                _released.wait_for(g, std::chrono::milliseconds(_wait_ms), [&]() {
+                    return pop_idle(ctx) || (reserved = reserve_context());
+                });
+                --_waiting;
+                if (ctx) {
+                    ++_stats.pool_hits;
+                    return *ctx;
+                }
             }
 
-            assert(ctx);
-            return *ctx;
+            if (!reserved) {
+                ++_stats.over_limit;
+                ++_context_count;
+            }
+            return *create_context();
         }
 
         void release(context& ctx) {
             --_aquired_count;
 
-            _queue.push(&ctx);
+            auto& slot = t_slots[_id];
+            if (slot.bound && slot.bound->ctx == &ctx) {
+                uint8_t expected = binding::busy;
+                if (_waiting == 0 && slot.bound->state.compare_exchange_strong(expected, binding::idle)) {
+                    return;
+                }
+                // the pool has been cleared (the context is doomed) or someone starves and the thread gives its context away
+                bool given_away = expected == binding::busy && unbind(*slot.bound);
+                slot.bound.reset();
+                if (!given_away) {
+                    destroy_context(&ctx);
+                    return;
+                }
+            }
+            else if (!slot.bound && _waiting == 0 && _context_count <= (int32_t)_max_contexts) {
+                slot.bound = bind(ctx);
+                return;
+            }
+
+            if (_context_count > (int32_t)_max_contexts || !push_idle(ctx)) {
+                destroy_context(&ctx);
+            }
+            else if (_waiting > 0) {
+                std::lock_guard<std::mutex> g{ _wait_mutex };
+                _released.notify_one();
+            }
+        }
+
+        void set_limits(const pool_limits& limits) {
+            _max_contexts = (std::max)(limits.max_contexts, 1u);
+            _wait_ms = limits.wait_ms;
+        }
+
+        pool_stats stats() const {
+            pool_stats result;
+            result.created = _stats.created;
+            result.thread_hits = _stats.thread_hits;
+            result.pool_hits = _stats.pool_hits;
+            result.waits = _stats.waits;
+            result.over_limit = _stats.over_limit;
+            result.peak_concurrency = _stats.peak_concurrency;
+            result.peak_contexts = _stats.peak_contexts;
+            result.contexts = (uint32_t)(std::max)(_context_count.load(), 0);
+            result.max_contexts = _max_contexts;
+            return result;
+        }
+
+        // Keeps @count idle contexts ready: creates the missing ones on a background thread now
+        // and again after each clear_state (game load or revert)
+        void prewarm(uint32_t count) {
+            std::lock_guard<std::mutex> g{ _prewarm_mutex };
+            _prewarm_size = count < queue_capacity ? count : queue_capacity;
+            stop_prewarmer();
+            start_prewarmer();
         }
 
+        // blocks until the background thread is done
+        void wait_prewarmed() {
+            std::lock_guard<std::mutex> g{ _prewarm_mutex };
+            if (_prewarmer.joinable()) {
+                _prewarmer.join();
+            }
+        }
+
+        bytecode_cache& bytecode() { return _bytecode; }
+
         explicit context_pool(tes_context& tc)
             : _tcontext(tc)
         {
@@ -223,28 +453,154 @@ namespace lua { namespace aux_wip {
 
         ~context_pool() {
             _tcontext.remove_dependent_context(*this);
+            {
+                std::lock_guard<std::mutex> g{ _prewarm_mutex };
+                stop_prewarmer();
+            }
             clear();
         }
 
         void clear_state() override {
+            std::lock_guard<std::mutex> g{ _prewarm_mutex };
+            stop_prewarmer();
             clear();
+            start_prewarmer();
         }
 
     private:
 
+        static void note_max(std::atomic<uint32_t>& peak, uint32_t value) {
+            uint32_t prev = peak;
+            while (prev < value && !peak.compare_exchange_weak(prev, value)) {}
+        }
+
+        void note_concurrency(int32_t active) {
+            note_max(_stats.peak_concurrency, (uint32_t)active);
+        }
+
+        bool pop_idle(context*& ctx) {
+            if (_queue.pop(ctx)) {
+                --_idle_count;
+                return true;
+            }
+            return false;
+        }
+
+        bool push_idle(context& ctx) {
+            ++_idle_count;
+            if (_queue.bounded_push(&ctx)) {
+                return true;
+            }
+            --_idle_count;
+            return false;
+        }
+
+        // takes a place for one more context unless @_max_contexts exist
+        bool reserve_context() {
+            int32_t count = _context_count;
+            while (count < (int32_t)_max_contexts) {
+                if (_context_count.compare_exchange_weak(count, count + 1)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // the place is already taken
+        context* create_context() {
+            ++_stats.created;
+            note_max(_stats.peak_contexts, (uint32_t)_context_count.load());
+            return new context(_tcontext, _bytecode);
+        }
+
+        void destroy_context(context* ctx) {
+            --_context_count;
+            delete ctx;
+        }
+
+        std::shared_ptr<binding> bind(context& ctx) {
+            std::lock_guard<std::mutex> g{ _bound_mutex };
+            u_delete_orphaned();
+            _bound.push_back(std::make_shared<binding>(ctx));
+            return _bound.back();
+        }
+
+        // false if the pool has been cleared meanwhile: the context is doomed then
+        bool unbind(binding& b) {
+            std::lock_guard<std::mutex> g{ _bound_mutex };
+            uint8_t expected = binding::busy;
+            if (!b.state.compare_exchange_strong(expected, binding::dead)) {
+                return false;
+            }
+            _bound.erase(std::find_if(_bound.begin(), _bound.end(), [&b](const std::shared_ptr<binding>& p) { return p.get() == &b; }));
+            return true;
+        }
+
+        // the contexts of the exited threads. Expects _bound_mutex to be locked
+        void u_delete_orphaned() {
+            _bound.erase(std::remove_if(_bound.begin(), _bound.end(), [this](const std::shared_ptr<binding>& b) {
+                uint8_t expected = binding::orphaned;
+                if (b->state.compare_exchange_strong(expected, binding::dead)) {
+                    destroy_context(b->ctx);
+                    return true;
+                }
+                return false;
+            }), _bound.end());
+        }
+
         void clear() {
             warn_if_aquired();
-            _queue.consume_all([](context *ctx) {
+            _queue.consume_all([this](context *ctx) {
                 assert(ctx);
-                delete ctx;
+                --_idle_count;
+                destroy_context(ctx);
+            });
+
+            std::lock_guard<std::mutex> g{ _bound_mutex };
+            for (auto& b : _bound) {
+                // a busy context is deleted by its thread, on release
+                auto prev = b->state.exchange(binding::doomed);
+                if (prev == binding::idle || prev == binding::orphaned) {
+                    b->state = binding::dead;
+                    destroy_context(b->ctx);
+                }
+            }
+            _bound.clear();
+        }
+
+        // both expect _prewarm_mutex to be locked
+        void start_prewarmer() {
+            if (_prewarm_size == 0) {
+                return;
+            }
+
+            _stop_prewarm = false;
+            _prewarmer = std::thread([this]() {
+                while (!_stop_prewarm && _idle_count < (int32_t)_prewarm_size && reserve_context()) {
+                    context *ctx = create_context();
+                    if (!push_idle(*ctx)) {
+                        destroy_context(ctx);
+                        break;
+                    }
+                }
             });
         }
 
+        void stop_prewarmer() {
+            if (_prewarmer.joinable()) {
+                _stop_prewarm = true;
+                _prewarmer.join();
+            }
+        }
+
         void warn_if_aquired() {
             jc_assert_msg(_aquired_count == 0, "Lua: %u lua-contexts are still active and used", _aquired_count.load ());
         }
     };
 
+    std::atomic<uint64_t> context_pool::s_last_pool_id = 0;
+    thread_local std::unordered_map<uint64_t, context_pool::thread_slot> context_pool::t_slots;
+
     // aquires a context from context_pool and releases it when destroyed
     class autofreed_context final : boost::noncopyable {
         context_pool& _pool;
@@ -322,6 +678,203 @@ namespace lua { namespace aux_wip {
     {
         EXPECT_TRUE(autofreed_context(pool)->eval_lua_function(nullptr, "return testing.perform()")->intValue() != 0);
     }
+
+    TEST_F(fixture, Lua_context_per_thread)
+    {
+        auto evalLuaInt = [&]() {
+            return autofreed_context(pool)->eval_lua_function(nullptr, "return 1")->intValue();
+        };
+
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ(1, evalLuaInt());
+        }
+        EXPECT_EQ(1, pool.stats().created);
+        EXPECT_EQ(9, pool.stats().thread_hits);
+
+        {   // nested evaluation can't use the busy thread context
+            autofreed_context outer(pool);
+            EXPECT_EQ(1, evalLuaInt());
+        }
+        EXPECT_EQ(2, pool.stats().created);
+        EXPECT_EQ(2, pool.stats().peak_concurrency);
+
+        std::thread([&]() { EXPECT_EQ(1, evalLuaInt()); EXPECT_EQ(1, evalLuaInt()); }).join();
+        EXPECT_EQ(1, pool.stats().pool_hits);   // took the idle one, now bound to the other thread
+
+        pool.clear_state();
+        EXPECT_EQ(0, pool.stats().contexts);
+        EXPECT_EQ(1, evalLuaInt());
+        EXPECT_EQ(3, pool.stats().created);
+    }
+
+    TEST_F(fixture, Lua_context_of_exited_thread)
+    {
+        auto evalLuaInt = [&]() {
+            return autofreed_context(pool)->eval_lua_function(nullptr, "return 1")->intValue();
+        };
+
+        std::thread([&]() { EXPECT_EQ(1, evalLuaInt()); }).join();
+        EXPECT_EQ(1, pool.stats().contexts);    // still bound to the exited thread
+
+        EXPECT_EQ(1, evalLuaInt());             // binding a context deletes the orphaned one
+        EXPECT_EQ(2, pool.stats().created);
+        EXPECT_EQ(1, pool.stats().contexts);
+        EXPECT_EQ(1, evalLuaInt());
+        EXPECT_EQ(1, pool.stats().thread_hits);
+    }
+
+    TEST_F(fixture, Lua_context_limit)
+    {
+        pool.set_limits(pool_limits{ 2, 50 });
+
+        std::atomic_int32_t evaluated = 0;
+        auto task = [&]() {
+            for (int i = 0; i < 20; ++i) {
+                autofreed_context lc(pool);
+                evaluated += lc->eval_lua_function(nullptr, "return 1")->intValue();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back(task);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        auto stats = pool.stats();
+        EXPECT_EQ(80, evaluated);
+        EXPECT_EQ(80u, stats.created + stats.thread_hits + stats.pool_hits);
+        EXPECT_TRUE(stats.peak_contexts <= 2 + stats.over_limit);
+        EXPECT_TRUE(stats.contexts <= stats.created);
+    }
+
+    TEST_F(fixture, Lua_map_iteration_perft)
+    {
+        const int size = 100000;
+        auto& obj = cl::map::object(tc);
+        obj.stack_retain();
+        for (int i = 0; i < size; ++i) {
+            obj.set(std::to_string(i), std::string("value #") + std::to_string(i));
+        }
+
+        size_t copied = 0;
+        util::do_with_timing("JMap_nextKey + JMap_getValue, copied strings", [&]() {
+            CString key = JMap_nextKey(&obj, nullptr);
+            while (key.str) {
+                JCToLuaValue value = JMap_getValue(&obj, key.str);
+                copied += value.stringLength;
+                JCToLuaValue_free(&value);
+
+                CString next = JMap_nextKey(&obj, key.str);
+                CString_free(&key);
+                key = next;
+            }
+        });
+
+        size_t borrowed = 0;
+        util::do_with_timing("JMap_getEntries, borrowed strings", [&]() {
+            enum { batch = 256 };
+            JCToLuaValue keys[batch], values[batch];
+            std::string lastKey;
+            index count = batch;
+            while (count == batch) {
+                JValue_borrowBegin(&obj);
+                count = JMap_getEntries(&obj, lastKey.empty() ? nullptr : lastKey.c_str(), keys, values, batch);
+                for (index i = 0; i < count; ++i) {
+                    borrowed += values[i].stringLength;
+                }
+                if (count > 0) {
+                    lastKey.assign(keys[count - 1].string, keys[count - 1].stringLength);
+                }
+                JValue_borrowEnd(&obj);
+            }
+        });
+        EXPECT_EQ(copied, borrowed);
+
+        util::do_with_timing("Lua pairs over JMap", [&]() {
+            auto length = autofreed_context(pool)->eval_lua_function(&obj,
+                "local n = 0; for k, v in pairs(jobject) do n = n + #v end; return n");
+            EXPECT_EQ((int32_t)borrowed, length->intValue());
+        });
+
+        obj.stack_release();
+    }
+
+    TEST_F(fixture, Lua_borrow_pins_instead_of_referencing)
+    {
+        auto& obj = cl::map::object(tc);
+        EXPECT_FALSE(util::epoch::is_pinned());
+
+        JValue_borrowBegin(&obj);
+        EXPECT_TRUE(util::epoch::is_pinned());
+        EXPECT_EQ(0, obj._refCount.load());
+        JValue_borrowEnd(&obj);
+
+        EXPECT_FALSE(util::epoch::is_pinned());
+        EXPECT_TRUE(obj._mutex.try_lock());
+        obj._mutex.unlock();
+    }
+
+    TEST_F(fixture, Lua_bulk_iteration)
+    {
+        const int size = 3000;  // a few JArray_getRange ranges and JMap_getEntries batches
+        auto& ints = cl::array::object(tc);
+        ints.u_set_layout(cl::array::layout::ints);
+        auto& strings = cl::array::object(tc);
+        auto& obj = cl::map::object(tc);
+        for (int i = 0; i < size; ++i) {
+            ints.u_ints()->push_back(i);
+            strings.u_push(item(std::to_string(i)));
+            obj.u_set(std::to_string(i), item(i));
+        }
+        obj.u_set("ints", ints);
+        obj.u_set("strings", strings);
+
+        auto evalLuaInt = [&](const char *script) {
+            return autofreed_context(pool)->eval_lua_function(&obj, script)->intValue();
+        };
+
+        EXPECT_EQ(size * (size - 1) / 2, evalLuaInt(
+            "local sum = 0; for i, v in ipairs(jobject.ints) do assert(i == v + 1); sum = sum + v end; return sum"));
+        EXPECT_EQ(size, evalLuaInt(
+            "local n = 0; for i, v in ipairs(jobject.strings) do assert(tonumber(v) == i - 1); n = n + 1 end; return n"));
+        EXPECT_EQ(size + 2, evalLuaInt(
+            "local n = 0; for k, v in pairs(jobject) do assert(type(v) ~= 'number' or tonumber(k) == v); n = n + 1 end; return n"));
+        EXPECT_EQ(cl::array::layout::ints, ints.u_layout());
+    }
+
+    TEST_F(fixture, Lua_evalLua_perft)
+    {
+        const char *script = "local sum = 0; for i = 1, 10 do sum = sum + i end; return sum";
+        auto evalLuaInt = [&]() {
+            return autofreed_context(pool)->eval_lua_function(nullptr, script)->intValue();
+        };
+
+        util::do_with_timing("evalLuaInt cold: new Lua context, script compiled", [&]() {
+            EXPECT_EQ(55, evalLuaInt());
+        });
+
+        pool.clear_state();
+        util::do_with_timing("evalLuaInt: new Lua context, shared bytecode", [&]() {
+            EXPECT_EQ(55, evalLuaInt());
+        });
+
+        pool.clear_state();
+        pool.bytecode().clear();
+        pool.prewarm(1);
+        pool.wait_prewarmed();
+        util::do_with_timing("evalLuaInt: pre-warmed Lua context, script compiled", [&]() {
+            EXPECT_EQ(55, evalLuaInt());
+        });
+
+        util::do_with_timing("evalLuaInt warm x 10000", [&]() {
+            for (int i = 0; i < 10000; ++i) {
+                EXPECT_EQ(55, evalLuaInt());
+            }
+        });
+    }
 #endif
 }
 }
@@ -333,6 +886,18 @@ namespace lua {
         return aux_wip::autofreed_context(*pool)->eval_lua_function(object, lua_string);
     }
 
+    void prewarm_contexts(tes_context& ctx, uint32_t count) {
+        static_cast<aux_wip::context_pool*>(ctx.lua_context.get())->prewarm(count);
+    }
+
+    pool_stats context_pool_stats(tes_context& ctx) {
+        return static_cast<aux_wip::context_pool*>(ctx.lua_context.get())->stats();
+    }
+
+    void set_context_pool_limits(tes_context& ctx, const pool_limits& limits) {
+        static_cast<aux_wip::context_pool*>(ctx.lua_context.get())->set_limits(limits);
+    }
+
     static tes_context::post_init g_extender([](tes_context& ctx){
         ctx.lua_context = std::make_shared<aux_wip::context_pool>(ctx);
     });
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace collections {
     class object_base;
     class item;
@@ -16,4 +18,28 @@ namespace lua {
     boost::optional<collections::item> eval_lua_function(   collections::tes_context& ctx,
                                                             collections::object_base *object,
                                                             const char *lua_string);
+
+    struct pool_limits {
+        uint32_t max_contexts = 0;
+        uint32_t wait_ms = 0;   // 0 - create a context right away once @max_contexts exist
+    };
+
+    /// Lua context pool counters since the domain was created
+    struct pool_stats {
+        uint32_t created = 0;           // contexts ever created
+        uint32_t thread_hits = 0;       // a thread reused the context bound to it
+        uint32_t pool_hits = 0;         // a thread took an idle shared context
+        uint32_t waits = 0;             // a thread had to wait for a context
+        uint32_t over_limit = 0;        // contexts created above the limit
+        uint32_t peak_concurrency = 0;  // max. contexts in use at once
+        uint32_t peak_contexts = 0;
+        uint32_t contexts = 0;          // alive now
+        uint32_t max_contexts = 0;
+    };
+
+    pool_stats context_pool_stats(collections::tes_context& ctx);
+    void set_context_pool_limits(collections::tes_context& ctx, const pool_limits& limits);
+
+    /// Keeps @count initialized Lua contexts ready for evalLua*, creating them on a background thread
+    void prewarm_contexts(collections::tes_context& ctx, uint32_t count);
 }
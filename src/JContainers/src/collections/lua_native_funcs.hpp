@@ -70,12 +70,14 @@ namespace lua { namespace api {
         return CString_copy(origin.c_str(), origin.size());
     }
 
-    JCToLuaValue JCToLuaValue_fromItem(const item& itm) {
+    // @borrow - the string points into the item instead of a copy that Lua must free
+    JCToLuaValue JCToLuaValue_fromItem(const item& itm, bool borrow = false) {
         struct t : public boost::static_visitor < > {
             JCToLuaValue value;
+            bool borrow;
 
             void operator ()(const std::string& str) {
-                value.string = CString_copy(str.c_str(), str.size()).str;
+                value.string = borrow ? str.c_str() : CString_copy(str.c_str(), str.size()).str;
                 value.stringLength = str.size();
             }
 
@@ -99,6 +101,7 @@ namespace lua { namespace api {
 
         } converter;
 
+        converter.borrow = borrow;
         converter.value.type = itm.type();
         itm.var().apply_visitor(converter);
         return converter.value;
@@ -177,14 +180,14 @@ namespace lua { namespace api {
 
     cexport handle JValue_retain(object_base* obj) { return (obj ? obj->stack_retain(), obj : nullptr); }
     cexport handle JValue_release(object_base* obj) { return (obj ? obj->stack_release(), nullptr : nullptr); }
-    cexport collections::CollectionType JValue_typeId(object_base* obj) { return (obj ? obj->_type : CollectionType::None); }
+    cexport uint32_t JValue_typeId(object_base* obj) { return (obj ? obj->_type : CollectionType::None); }
 
     cexport JCToLuaValue JValue_solvePath(tes_context *context, object_base *obj, cstring path) {
         namespace ca = collections::ca;
         assert(context && "context is null");
         auto value = JCToLuaValue_None();
         if (obj) {
-            ca::visit_value(*obj, path, ca::constant, [&value](const item &itm) {
+            ca::read_value(*obj, path, [&value](const item &itm) {
                 value = JCToLuaValue_fromItem(&itm);
             });
         }
@@ -194,7 +197,7 @@ namespace lua { namespace api {
     cexport JCToLuaValue JArray_getValue(array* obj, index key) {
         JCToLuaValue v(JCToLuaValue_None());
         array_functions::doReadOp(obj, key, [=, &v](index idx) {
-            v = JCToLuaValue_fromItem(obj->u_container()[idx]);
+            obj->u_read_at(idx, [&v](const item& itm) { v = JCToLuaValue_fromItem(itm); });
         });
         //std::cout << "value returned: " << JCValue_toString(v) << std::endl;
         return v;
@@ -215,6 +218,21 @@ namespace lua { namespace api {
         //std::cout << "value assigned: " << JCValue_toString(val) << std::endl;
     }
 
+    // Borrowed mode only (see JValue_borrowBegin). Fills @out with the values at [@from, @to), returns their number
+    cexport index JArray_getRange(const array* obj, index from, index to, JCToLuaValue* out) {
+        if (!obj || !out) {
+            return 0;
+        }
+
+        from = (std::max)(from, 0);
+        to = (std::min)(to, (index)obj->u_count());
+
+        for (index i = from; i < to; ++i) {
+            obj->u_read_at(i, [&](const item& itm) { out[i - from] = JCToLuaValue_fromItem(itm, true); });
+        }
+        return (std::max)(to - from, 0);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     cexport CString JMap_nextKey(const map *obj, cstring lastKey) {
         CString next = CString_None();
@@ -229,6 +247,46 @@ namespace lua { namespace api {
     cexport JCToLuaValue JMap_getValue(map *obj, cstring key) {
         return map_functions::doReadOpR(obj, key, JCToLuaValue_None(), [](item& itm) { return JCToLuaValue_fromItem(itm); });
     }
+
+    // Borrowed mode. The object stays locked between JValue_borrowBegin and JValue_borrowEnd, the strings
+    // returned within point into its storage and are valid until JValue_borrowEnd - nothing to copy or free.
+    // No other function that locks the object may be called inside the scope. The thread pins util::epoch
+    // for the scope instead of referencing the object
+    cexport void JValue_borrowBegin(object_base* obj) {
+        if (obj) {
+            util::epoch::pin();
+            obj->mutex().lock();
+        }
+    }
+
+    cexport void JValue_borrowEnd(object_base* obj) {
+        if (obj) {
+            obj->mutex().unlock();
+            util::epoch::unpin();
+        }
+    }
+
+    // Borrowed mode only. Fills up to @capacity key/value pairs that follow @lastKey (the first ones if @lastKey is null)
+    // into @keys and @values. Returns the number of pairs filled, less than @capacity at the end of the map
+    cexport index JMap_getEntries(const map *obj, cstring lastKey, JCToLuaValue* keys, JCToLuaValue* values, index capacity) {
+        if (!obj || !keys || !values || capacity <= 0) {
+            return 0;
+        }
+
+        auto& container = obj->u_container();
+        auto itr = lastKey ? container.upper_bound(util::folded_key(lastKey)) : container.begin();
+
+        index filled = 0;
+        for (const auto end = container.end(); itr != end && filled < capacity; ++itr, ++filled) {
+            const std::string& key = itr->first.str();
+            keys[filled].type = item_type::string;
+            keys[filled].string = key.c_str();
+            keys[filled].stringLength = (uint32_t)key.size();
+            values[filled] = JCToLuaValue_fromItem(itr->second, true);
+        }
+        return filled;
+    }
+
     //////////////////////////////////////////////////////////////////////////
 
     static_assert(sizeof FormId == sizeof CForm, "");
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "collections/collections.h"
+#include "collections/context.h"
 
+#include <set>
 #include <thread>
 #include "meta.h"
 #include "util/istring.h"
@@ -11,30 +13,43 @@ namespace collections {
     namespace operators
     {
         using istring = util::istring;
-        typedef void (*operator_func)(const item& val, item& state);
+
+        /// The running state of an operator. Each operator of a path like "@sum,avg.value" has its own
+        struct accumulator {
+            item value;                 // the result, unless the operator has a finish function
+            double sum = 0.0;
+            uint32_t count = 0;
+            bool has_reals = false;
+            std::set<item> seen;        // @distinct
+            std::vector<item> values;   // @distinct, in the order of visiting
+        };
+
+        typedef void (*operator_func)(const item& val, accumulator& state);
+        typedef item (*finish_func)(accumulator& state, tes_context& context);
 
         struct coll_operator {
             operator_func func;
+            finish_func finish;
             const char *func_name;
             const char *description;
 
-            static coll_operator make(operator_func _func, const char *_func_name, const char *_description) {
-                coll_operator op = {_func, _func_name, _description};
+            static coll_operator make(operator_func _func, finish_func _finish, const char *_func_name, const char *_description) {
+                coll_operator op = {_func, _finish, _func_name, _description};
                 return op;
             }
+
+            item result(accumulator& state, tes_context& context) const {
+                return finish ? finish(state, context) : state.value;
+            }
         };
 
         typedef std::map<istring, coll_operator*> operator_map;
 
 #define COLLECTION_OPERATOR(func, descr) \
-    static ::meta<coll_operator> g_collection_operator_##func(coll_operator::make(func, #func, descr));
+    static ::meta<coll_operator> g_collection_operator_##func(coll_operator::make(func, nullptr, #func, descr));
 
-        template<class Key>
-        static coll_operator* get_operator(const Key& key) {
-            auto& omap = operators();
-            auto itr = omap.find(key);
-            return itr != omap.end() ? itr->second : nullptr;
-        }
+#define COLLECTION_OPERATOR_FINISH(func, finish, descr) \
+    static ::meta<coll_operator> g_collection_operator_##func(coll_operator::make(func, finish, #func, descr));
 
         static operator_map& operators() {
 
@@ -51,61 +66,121 @@ namespace collections {
             return op_map;
         }
 
-        void maxNum(const item& val, item& state) {
+        template<class Key>
+        static coll_operator* get_operator(const Key& key) {
+            auto& omap = operators();
+            auto itr = omap.find(key);
+            return itr != omap.end() ? itr->second : nullptr;
+        }
+
+        void maxNum(const item& val, accumulator& acc) {
             if (val.isNumber()) {
-                state = state.isNull() ? val : item(
-                    (std::max)(val.fltValue(), state.fltValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::max)(val.fltValue(), acc.value.fltValue())
                     );
             }
         }
         COLLECTION_OPERATOR(maxNum, "returns maximum number (int or float) in collection");
 
-        void minNum(const item& val, item& state) {
+        void minNum(const item& val, accumulator& acc) {
             if (val.isNumber()) {
-                state = state.isNull() ? val : item(
-                    (std::min)(val.fltValue(), state.fltValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::min)(val.fltValue(), acc.value.fltValue())
                     );
             }
         }
         COLLECTION_OPERATOR(minNum, "returns minimum number (int or float) in collection");
 
-        void maxFlt(const item& val, item& state) {
+        void maxFlt(const item& val, accumulator& acc) {
             if (val.is_type<item::Real>()) {
-                state = state.isNull() ? val : item(
-                    (std::max)(val.fltValue(), state.fltValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::max)(val.fltValue(), acc.value.fltValue())
                     );
             }
         }
         COLLECTION_OPERATOR(maxFlt, "returns maximum float number in collection");
 
-        void minFlt(const item& val, item& state) {
+        void minFlt(const item& val, accumulator& acc) {
             if (val.is_type<item::Real>()) {
-                state = state.isNull() ? val : item(
-                    (std::min)(val.fltValue(), state.fltValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::min)(val.fltValue(), acc.value.fltValue())
                     );
             }
         }
         COLLECTION_OPERATOR(minFlt, "returns minimum float number collection");
 
-        void maxInt(const item& val, item& state) {
+        void maxInt(const item& val, accumulator& acc) {
             if (val.is_type<SInt32>()) {
-                state = state.isNull() ? val : item(
-                    (std::max)(val.intValue(), state.intValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::max)(val.intValue(), acc.value.intValue())
                     );
             }
         }
         COLLECTION_OPERATOR(maxInt, "returns maximum int number in collection");
 
-        void minInt(const item& val, item& state) {
+        void minInt(const item& val, accumulator& acc) {
             if (val.is_type<SInt32>()) {
-                state = state.isNull() ? val : item(
-                    (std::min)(val.intValue(), state.intValue())
+                acc.value = acc.value.isNull() ? val : item(
+                    (std::min)(val.intValue(), acc.value.intValue())
                     );
             }
         }
         COLLECTION_OPERATOR(minInt, "returns minimum int number in collection");
 
+        void sum(const item& val, accumulator& acc) {
+            if (val.isNumber()) {
+                acc.sum += val.fltValue();
+                acc.has_reals |= val.is_type<item::Real>();
+                ++acc.count;
+            }
+        }
+        item sum_result(accumulator& acc, tes_context&) {
+            return acc.has_reals ? item((item::Real)acc.sum) : item((SInt32)acc.sum);
+        }
+        COLLECTION_OPERATOR_FINISH(sum, sum_result, "returns the sum of numbers (float if any of them is float, int otherwise) in collection");
+
+        void avg(const item& val, accumulator& acc) {
+            sum(val, acc);
+        }
+        item avg_result(accumulator& acc, tes_context&) {
+            return acc.count ? item((item::Real)(acc.sum / acc.count)) : item();
+        }
+        COLLECTION_OPERATOR_FINISH(avg, avg_result, "returns the average of numbers (int or float) in collection");
+
+        void count(const item& val, accumulator& acc) {
+            ++acc.count;
+        }
+        item count_result(accumulator& acc, tes_context&) {
+            return item((SInt32)acc.count);
+        }
+        COLLECTION_OPERATOR_FINISH(count, count_result, "returns the number of values in collection");
+
+        void distinct(const item& val, accumulator& acc) {
+            if (acc.seen.insert(val).second) {
+                acc.values.push_back(val);
+            }
+        }
+        item distinct_result(accumulator& acc, tes_context& context) {
+            return item(array::objectWithInitializer([&](array& arr) {
+                arr.u_container() = std::move(acc.values);
+            },
+                context));
+        }
+        COLLECTION_OPERATOR_FINISH(distinct, distinct_result, "returns a new array of the distinct values in collection, in the order they were found");
+
+        void first(const item& val, accumulator& acc) {
+            if (acc.count++ == 0) {
+                acc.value = val;
+            }
+        }
+        COLLECTION_OPERATOR(first, "returns the first value in collection");
+
+        void last(const item& val, accumulator& acc) {
+            acc.value = val;
+        }
+        COLLECTION_OPERATOR(last, "returns the last value in collection");
 
+#undef COLLECTION_OPERATOR_FINISH
 #undef COLLECTION_OPERATOR
     };
 
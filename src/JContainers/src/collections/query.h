@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "util/case_fold.h"
+#include "util/istring.h"
+#include "util/worker_pool.h"
+#include "collections/collections.h"
+#include "collections/access.h"
+
+namespace collections {
+
+    /// Native queries over collection values: filter, count, sum, sort and group by the value at a path.
+    /// The values are copied under the collection's lock, then the paths are resolved
+    /// on the worker pool, in chunks of @parallel_chunk values
+    namespace query {
+
+        static const size_t parallel_chunk = 2048;
+
+        enum class comparison { equal, not_equal, less, less_equal, greater, greater_equal };
+
+        inline boost::optional<comparison> parse_comparison(const char *str) {
+            if (!str) {
+                return boost::none;
+            }
+            static const std::pair<const char*, comparison> known[] = {
+                { "==", comparison::equal }, { "=", comparison::equal }, { "!=", comparison::not_equal },
+                { "<", comparison::less }, { "<=", comparison::less_equal },
+                { ">", comparison::greater }, { ">=", comparison::greater_equal },
+            };
+            for (auto& k : known) {
+                if (strcmp(k.first, str) == 0) {
+                    return k.second;
+                }
+            }
+            return boost::none;
+        }
+
+        /// A copy of the values (not the keys) of a collection. Packed arrays stay packed
+        inline std::vector<item> values_of(object_base& obj) {
+            struct {
+                std::vector<item> values;
+
+                void operator()(array& arr) {
+                    values.reserve(arr.u_count());
+                    for (int32_t i = 0; i < arr.u_count(); ++i) {
+                        arr.u_read_at(i, [this](const item& itm) { values.push_back(itm); });
+                    }
+                }
+
+                template<class Map>
+                void operator()(Map& cnt) {
+                    values.reserve(cnt.u_count());
+                    for (auto& pair : cnt.u_container()) {
+                        values.push_back(pair.second);
+                    }
+                }
+            } helper;
+
+            object_read_lock g(obj);
+            perform_on_object(obj, helper);
+            return std::move(helper.values);
+        }
+
+        /// The value at the @path of the @itm, the item itself if the @path is empty
+        inline item value_at(tes_context& ctx, item& itm, const char *path) {
+            if (!path || !*path) {
+                return itm;
+            }
+            item result;
+            path_resolving::resolve(ctx, itm, path, [&result](item *found) {
+                if (found) {
+                    result = *found;
+                }
+            });
+            return result;
+        }
+
+        /// Numbers (int and float mixed) and strings (case-insensitive) are ordered,
+        /// forms and objects can be equal only. None if the values aren't comparable
+        inline boost::optional<int> compare(const item& l, const item& r) {
+            if (l.isNumber() && r.isNumber()) {
+                if (l.is_type<SInt32>() && r.is_type<SInt32>()) {
+                    return l.intValue() < r.intValue() ? -1 : (r.intValue() < l.intValue() ? 1 : 0);
+                }
+                double lv = l.fltValue(), rv = r.fltValue();
+                return lv < rv ? -1 : (rv < lv ? 1 : 0);
+            }
+            if (l.type() != r.type() || l.isNull()) {
+                return boost::none;
+            }
+            if (l.is_type<std::string>()) {
+                return util::case_fold::compare(*l.get<std::string>(), *r.get<std::string>());
+            }
+            return l == r ? boost::make_optional(0) : boost::none;
+        }
+
+        inline bool matches(const item& value, comparison op, const item& operand) {
+            auto order = compare(value, operand);
+            if (!order) {
+                return op == comparison::not_equal;
+            }
+            switch (op) {
+            case comparison::equal:         return *order == 0;
+            case comparison::not_equal:     return *order != 0;
+            case comparison::less:          return *order < 0;
+            case comparison::less_equal:    return *order <= 0;
+            case comparison::greater:       return *order > 0;
+            default:                        return *order >= 0;
+            }
+        }
+
+        /// Resolves the @path of each value, in parallel
+        inline std::vector<item> values_at(tes_context& ctx, std::vector<item>& values, const char *path) {
+            std::vector<item> result(values.size());
+            util::worker_pool::instance().parallel_for(values.size(), parallel_chunk, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    result[i] = value_at(ctx, values[i], path);
+                }
+            });
+            return result;
+        }
+
+        /// The values whose @path value compares to the @operand, in the original order
+        inline std::vector<item> filter(tes_context& ctx, std::vector<item>& values, const char *path, comparison op, const item& operand) {
+            std::vector<char> keep(values.size());
+            util::worker_pool::instance().parallel_for(values.size(), parallel_chunk, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    keep[i] = matches(value_at(ctx, values[i], path), op, operand);
+                }
+            });
+
+            std::vector<item> result;
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (keep[i]) {
+                    result.push_back(std::move(values[i]));
+                }
+            }
+            return result;
+        }
+
+        inline size_t count_if(tes_context& ctx, std::vector<item>& values, const char *path, comparison op, const item& operand) {
+            std::atomic<size_t> count{ 0 };
+            util::worker_pool::instance().parallel_for(values.size(), parallel_chunk, [&](size_t begin, size_t end) {
+                size_t chunk_count = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    chunk_count += matches(value_at(ctx, values[i], path), op, operand);
+                }
+                count += chunk_count;
+            });
+            return count;
+        }
+
+        struct numeric_summary {
+            double sum = 0.0;
+            size_t count = 0;   // numbers only, other values are skipped
+        };
+
+        inline numeric_summary summarize(tes_context& ctx, std::vector<item>& values, const char *path) {
+            numeric_summary total;
+            std::mutex total_mutex;
+            util::worker_pool::instance().parallel_for(values.size(), parallel_chunk, [&](size_t begin, size_t end) {
+                numeric_summary chunk;
+                for (size_t i = begin; i < end; ++i) {
+                    item value = value_at(ctx, values[i], path);
+                    if (value.isNumber()) {
+                        chunk.sum += value.is_type<SInt32>() ? (double)value.intValue() : (double)value.fltValue();
+                        ++chunk.count;
+                    }
+                }
+                std::lock_guard<std::mutex> g{ total_mutex };
+                total.sum += chunk.sum;
+                total.count += chunk.count;
+            });
+            return total;
+        }
+
+        /// Numbers by value (an int and a float too), strings case-insensitively. The other values
+        /// are ordered by type as JArray.sort orders items: none < numbers < form < object < string
+        inline bool sort_less(const item& l, const item& r) {
+            if (auto order = compare(l, r)) {
+                return *order < 0;
+            }
+            return l < r;
+        }
+
+        /// The order of a stable sort by the @path values: the value which goes to the i-th place is values[order[i]]
+        inline std::vector<size_t> sort_order(tes_context& ctx, std::vector<item>& values, const char *path, bool ascending) {
+            std::vector<item> keys = values_at(ctx, values, path);
+            std::vector<size_t> order(values.size());
+            std::iota(order.begin(), order.end(), size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+                return ascending ? sort_less(keys[l], keys[r]) : sort_less(keys[r], keys[l]);
+            });
+            return order;
+        }
+
+        /// True if the @arr still holds exactly the @values, strings compared case-sensitively. The @arr must be locked
+        inline bool u_holds(const array& arr, const std::vector<item>& values) {
+            if ((size_t)arr.u_count() != values.size()) {
+                return false;
+            }
+            bool same = true;
+            for (uint32_t i = 0; same && i < values.size(); ++i) {
+                arr.u_read_at(i, [&](const item& itm) {
+                    const item& v = values[i];
+                    same = itm.type() == v.type() && !(itm < v) && !(v < itm)
+                        && (!itm.is_type<std::string>() || *itm.get<std::string>() == *v.get<std::string>());
+                });
+            }
+            return same;
+        }
+
+        /// Moves the values[order[i]] to the i-th place. Packed arrays stay packed. The @arr must be locked
+        inline void u_reorder(array& arr, const std::vector<size_t>& order) {
+            auto reorder = [&order](auto& values) {
+                std::remove_reference_t<decltype(values)> sorted;
+                sorted.reserve(values.size());
+                for (size_t idx : order) {
+                    sorted.push_back(std::move(values[idx]));
+                }
+                values.swap(sorted);
+            };
+
+            if (auto ints = arr.u_ints()) {
+                reorder(*ints);
+            }
+            else if (auto floats = arr.u_floats()) {
+                reorder(*floats);
+            }
+            else {
+                reorder(arr.u_container());
+            }
+        }
+
+        /// Groups the values by their @path value converted to a string. Values whose @path value
+        /// is neither a string nor a number are left out. The groups keep the original order
+        inline std::map<util::istring, std::vector<item>> group_by(tes_context& ctx, std::vector<item>& values, const char *path) {
+            std::vector<item> keys = values_at(ctx, values, path);
+            std::map<util::istring, std::vector<item>> groups;
+            for (size_t i = 0; i < values.size(); ++i) {
+                const item& key = keys[i];
+                if (key.is_type<std::string>()) {
+                    groups[key.strValue()].push_back(std::move(values[i]));
+                }
+                else if (key.isNumber()) {
+                    char number[32];
+                    if (key.is_type<SInt32>()) {
+                        snprintf(number, sizeof number, "%d", key.intValue());
+                    }
+                    else {
+                        snprintf(number, sizeof number, "%g", key.fltValue());
+                    }
+                    groups[number].push_back(std::move(values[i]));
+                }
+            }
+            return groups;
+        }
+    }
+}
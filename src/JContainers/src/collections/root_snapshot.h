@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+#include "util/spinlock.h"
+#include "util/string_pool.h"
+#include "collections/collections.h"
+
+namespace collections {
+
+    /**
+     * Read-copy-update table of the JDB top-level keys. JDB readers look the first path element up in an immutable
+     * version instead of locking the root map. Any root change drops the version and the next reader builds a new one
+     * under the root lock. A reader which still holds a dropped version sees the JDB as it was before the change,
+     * the version's items keep their objects alive.
+     * Lock order: the root lock, then the snapshot one
+     */
+    class root_snapshot {
+
+        struct key_hash {
+            size_t operator()(const util::folded_key& k) const { return k.hash; }
+        };
+
+        struct key_equal {
+            bool operator()(const util::folded_key& l, const util::folded_key& r) const {
+                return l.hash == r.hash && l.folded == r.folded;
+            }
+        };
+
+    public:
+
+        struct version {
+            std::unordered_map<util::folded_key, item, key_hash, key_equal> keys;
+
+            const item* find(const util::folded_key& key) const {
+                auto itr = keys.find(key);
+                return itr != keys.end() ? &itr->second : nullptr;
+            }
+        };
+
+        using version_ref = std::shared_ptr<const version>;
+
+        /// The version of the current root, null if it has changed since the last build
+        version_ref current() const {
+            return std::atomic_load_explicit(&_current, std::memory_order_acquire);
+        }
+
+        /// Builds the version of the @root and publishes it if the @root is still the JDB root. The @root must be locked, a shared lock will do:
+        /// concurrent builders publish equal versions
+        version_ref u_publish(const map& root) {
+            if (auto existing = current()) {
+                return existing; // another reader has been first
+            }
+
+            auto fresh = std::make_shared<version>();
+            fresh->keys.reserve(root.u_count());
+            for (auto& pair : root.u_container()) {
+                fresh->keys.emplace(util::folded_key(pair.first.folded()), pair.second);
+            }
+
+            util::spinlock::guard g{ _lock };
+            if (_root.load(std::memory_order_relaxed) == &root) {
+                std::atomic_store_explicit(&_current, version_ref(fresh), std::memory_order_release);
+            }
+            return fresh;
+        }
+
+        /// Called by every map which changes, with the map locked
+        void u_changed(const map& obj) {
+            if (_root.load(std::memory_order_relaxed) == &obj) {
+                reset(&obj);
+            }
+        }
+
+        /// Drops the version, the @root becomes the one whose versions get published
+        void reset(const map* root) {
+            version_ref dropped; // released out of the lock
+            util::spinlock::guard g{ _lock };
+            _root.store(root, std::memory_order_relaxed);
+            dropped = std::atomic_exchange_explicit(&_current, version_ref(), std::memory_order_acq_rel);
+        }
+
+    private:
+        util::spinlock _lock;
+        std::atomic<const map*> _root{ nullptr };
+        version_ref _current;
+    };
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "gtest.h"
+#include "collections/context.h"
+
+namespace collections {
+
+    struct JCFixture : public ::testing::Test {
+        tes_context_standalone context;
+
+/*
+        void SetUpTestCase(){}
+        void TearDownTestCase(){}*/
+    };
+
+#   define JC_TEST(name, name2) TEST_F(JCFixture, name ## _ ## name2)
+#   define JC_TEST_DISABLED(name, name2) TEST_F(JCFixture, name ## _DISABLED_ ## name2)
+
+}
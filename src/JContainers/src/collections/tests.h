@@ -1,19 +1,14 @@
 #pragma once
 
-namespace collections {
+#include <thread>
+#include <boost/filesystem.hpp>
 
-    struct JCFixture : public ::testing::Test {
-        tes_context_standalone context;
-
-/*
-        void SetUpTestCase(){}
-        void TearDownTestCase(){}*/
-    };
-
-#   define JC_TEST(name, name2) TEST_F(JCFixture, name ## _ ## name2)
-#   define JC_TEST_DISABLED(name, name2) TEST_F(JCFixture, name ## _DISABLED_ ## name2)
-
-}
+#include "util/util.h"
+#include "forms/form_handling.h"
+#include "collections/test_fixture.h"
+#include "collections/json_serialization.h"
+#include "collections/copying.h"
+#include "collections/access.h"
 
 namespace collections { namespace {
 
@@ -44,6 +39,29 @@ namespace collections { namespace {
         //EXPECT_TRUE(obj->refCount() == 1);
     }
 
+    JC_TEST(object_base, tag)
+    {
+        auto& root = map::object(context);
+        context.set_root(&root);
+        auto& obj = map::object(context);
+        root.u_set("tagged", obj);
+
+        EXPECT_TRUE(obj.has_equal_tag(""));
+        obj.set_tag("Location");
+        EXPECT_TRUE(obj._tagged);
+        EXPECT_TRUE(obj.has_equal_tag("location"));
+        EXPECT_FALSE(root.has_equal_tag("location"));
+
+        auto data = context.write_to_string();
+        context.read_from_string(data);
+        auto loaded = context.root().u_get("tagged")->object();
+        EXPECT_TRUE(loaded->has_equal_tag("LOCATION"));
+
+        loaded->set_tag(nullptr);
+        EXPECT_FALSE(loaded->_tagged);
+        EXPECT_FALSE(loaded->has_equal_tag("location"));
+    }
+
 
     JC_TEST(item, nulls)
     {
@@ -606,6 +624,45 @@ namespace collections { namespace {
         EXPECT_TRUE(*cnt.u_get("acdc") == name);
     }
 
+    JC_TEST(map, interned_keys)
+    {
+        map &a = map::object(context);
+        map &b = map::object(context);
+
+        a.u_set("Health", 1);
+        b.u_set("health", 2);
+        b.u_set(std::string("HEALTH"), 3);
+
+        EXPECT_EQ(1, b.u_count());
+        EXPECT_EQ("health", b.u_container().begin()->first.str()); // the first spelling is kept
+        EXPECT_EQ(a.u_container().begin()->first.folded_id(), b.u_container().begin()->first.folded_id());
+        EXPECT_EQ(3, b.u_get("Health")->intValue());
+
+        map &c = map::object(context);
+        c.u_set("Health", 4);
+        EXPECT_EQ(a.u_container().begin()->first.id(), c.u_container().begin()->first.id());
+    }
+
+    JC_TEST(map, interned_keys_serialization)
+    {
+        auto& root = map::object(context);
+        context.set_root(&root);
+
+        for (int i = 0; i < 100; ++i) {
+            auto& m = map::object(context);
+            m.u_set("SomeRatherLongKeyName", i);
+            root.u_set(std::to_string(i), m);
+        }
+
+        auto data = context.write_to_string();
+        EXPECT_EQ(data.find("SomeRatherLongKeyName"), data.rfind("SomeRatherLongKeyName")); // written once
+
+        context.read_from_string(data);
+        auto& loaded = context.root();
+        EXPECT_EQ(100, loaded.u_count());
+        EXPECT_EQ(42, loaded.u_get("42")->object()->as<map>()->u_get("someratherlongkeyname")->intValue());
+    }
+
     JC_TEST(tes_context, root)
     {
         auto& db = context.root();
@@ -706,6 +763,163 @@ namespace collections { namespace {
         EXPECT_TRUE(allDestroyed(privateIds));
     }
 
+    TEST(rw_spinlock, readers_share_writers_exclude)
+    {
+        util::rw_spinlock lock;
+        lock.lock_shared();
+        EXPECT_TRUE(lock.try_lock_shared());
+        EXPECT_FALSE(lock.try_lock());
+        lock.unlock_shared();
+        lock.unlock_shared();
+
+        EXPECT_TRUE(lock.try_lock());
+        EXPECT_FALSE(lock.try_lock_shared());
+        lock.unlock();
+        EXPECT_TRUE(lock.try_lock_shared());
+        lock.unlock_shared();
+
+        for (int i = 0; i < 127; ++i) {
+            EXPECT_TRUE(lock.try_lock_shared());
+        }
+        EXPECT_FALSE(lock.try_lock_shared()); // the reader count is full
+        for (int i = 0; i < 127; ++i) {
+            lock.unlock_shared();
+        }
+        EXPECT_TRUE(lock.try_lock());
+        lock.unlock();
+    }
+
+    JC_TEST(object_read_lock, arrays_are_shared)
+    {
+        auto& m = map::object(context);
+        auto& arr = array::object(context);
+        {
+            object_read_lock r(m);
+            EXPECT_TRUE(m._mutex.try_lock_shared());
+            m._mutex.unlock_shared();
+            EXPECT_FALSE(m._mutex.try_lock());
+        }
+        {
+            object_read_lock r(arr);
+            EXPECT_TRUE(arr._mutex.try_lock_shared());
+            arr._mutex.unlock_shared();
+            EXPECT_FALSE(arr._mutex.try_lock());
+        }
+    }
+
+    // the const reads of a packed array leave it packed
+    JC_TEST(array, const_reads_stay_packed)
+    {
+        auto& root = map::object(context);
+        auto& arr = array::object(context);
+        arr.u_set_layout(array::layout::ints);
+        arr.u_ints()->assign({ 10, 20, 30 });
+        root.u_set("numbers", arr);
+
+        EXPECT_EQ(20, arr.get_item(1)->readAs<SInt32>());
+        EXPECT_EQ(30, arr.get_item(-1)->readAs<SInt32>());
+        EXPECT_FALSE(arr.get_item(3));
+        EXPECT_EQ(3u, arr.container_copy().size());
+        EXPECT_EQ(10, ca::get<SInt32>(root, ".numbers[0]").get_value_or(0));
+        EXPECT_EQ(10, ca::get(arr, "[0]")->readAs<SInt32>());
+
+        SInt32 resolved = 0;
+        path_resolving::resolve(context, &root, ".numbers[2]", [&resolved](item* itm) { resolved = itm ? itm->readAs<SInt32>() : -1; });
+        EXPECT_EQ(30, resolved);
+        path_resolving::resolve(context, &root, ".numbers[3]", [&resolved](item* itm) { resolved = itm ? itm->readAs<SInt32>() : -1; });
+        EXPECT_EQ(-1, resolved);
+        EXPECT_EQ(array::layout::ints, arr.u_layout());
+
+        arr.u_get(0); // the non-const accessors unpack
+        EXPECT_EQ(array::layout::items, arr.u_layout());
+        EXPECT_EQ(10, ca::get<SInt32>(root, ".numbers[0]").get_value_or(0));
+    }
+
+    TEST(epoch, pinned_thread_holds_back_reclamation)
+    {
+        std::atomic<bool> pinned{ false }, leave{ false };
+        std::thread reader([&]() {
+            util::epoch::guard g;
+            util::epoch::guard nested;
+            pinned = true;
+            while (!leave) {
+                std::this_thread::yield();
+            }
+        });
+        while (!pinned) {
+            std::this_thread::yield();
+        }
+
+        auto tag = util::epoch::retire_tag();
+        EXPECT_FALSE(tag < util::epoch::reclaim_bound()); // the reader might have seen the object
+        leave = true;
+        reader.join();
+        EXPECT_TRUE(tag < util::epoch::reclaim_bound());
+        EXPECT_FALSE(util::epoch::is_pinned());
+    }
+
+    JC_TEST(object_context, retired_object_outlives_borrowers)
+    {
+        map& obj = map::make(context);
+        obj.u_set("key", item(1));
+        auto hdl = obj.public_id();
+
+        std::atomic<bool> borrowed{ false }, leave{ false };
+        std::thread reader([&]() {
+            util::epoch::guard g;
+            map* m = context.getObjectOfType<map>(hdl); // what a borrowing native function does
+            EXPECT_EQ(&obj, m);
+            EXPECT_EQ(0, m->_refCount.load());
+            borrowed = true;
+            while (!leave) {
+                std::this_thread::yield();
+            }
+            EXPECT_EQ(0, m->s_count()); // cleared, not freed
+        });
+        while (!borrowed) {
+            std::this_thread::yield();
+        }
+
+        context.retire(obj);
+        EXPECT_EQ(nullptr, context.getObject(hdl));
+        context.reclaim();
+        EXPECT_EQ(1u, context.retired_count());
+
+        leave = true;
+        reader.join();
+        context.reclaim();
+        EXPECT_EQ(0u, context.retired_count());
+    }
+
+    // a long pin doesn't turn every retire into a reclaim pass over the whole list
+    JC_TEST(object_context, retire_while_pinned_reclaims_geometrically)
+    {
+        std::atomic<bool> pinned{ false }, leave{ false };
+        std::thread reader([&]() {
+            util::epoch::guard g;
+            pinned = true;
+            while (!leave) {
+                std::this_thread::yield();
+            }
+        });
+        while (!pinned) {
+            std::this_thread::yield();
+        }
+
+        const size_t count = 100000;
+        util::do_with_timing("retire 100000 objects while pinned", [&]() {
+            for (size_t i = 0; i < count; ++i) {
+                context.retire(map::make(context));
+            }
+        });
+        EXPECT_EQ(count, context.retired_count());
+
+        leave = true;
+        reader.join();
+        context.reclaim();
+        EXPECT_EQ(0u, context.retired_count());
+    }
+
     JC_TEST(deadlock, _)
     {
         auto& obj = map::object(context);
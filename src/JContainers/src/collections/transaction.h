@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "util/case_fold.h"
+#include "util/epoch.h"
+#include "collections/collections.h"
+#include "collections/access.h"
+
+namespace collections {
+
+    /// Batched read-modify-write over several paths. The containers the paths end in are locked all at once,
+    /// in the order of their addresses, so two transactions never deadlock and nobody sees half of a batch
+    namespace transaction {
+
+        enum class operation {
+            set,
+            add,
+            mul,
+            div,
+            mod,
+            bit_and,
+            bit_or,
+            bit_xor,
+        };
+
+        inline boost::optional<operation> parse_operation(const char* name) {
+            static const struct { const char* name; operation op; } names[] = {
+                { "set", operation::set },
+                { "add", operation::add },
+                { "mul", operation::mul },
+                { "div", operation::div },
+                { "mod", operation::mod },
+                { "and", operation::bit_and },
+                { "or",  operation::bit_or },
+                { "xor", operation::bit_xor },
+            };
+
+            if (name) {
+                for (auto& n : names) {
+                    if (util::case_fold::equals(n.name, name)) {
+                        return n.op;
+                    }
+                }
+            }
+            return boost::none;
+        }
+
+        template<class T>
+        struct step {
+            std::string path;
+            operation op;
+            T value;
+        };
+
+        namespace detail {
+
+            inline boost::optional<SInt32> compute(operation op, SInt32 current, SInt32 value) {
+                switch (op) {
+                case operation::set:        return value;
+                case operation::add:        return (SInt32)((uint32_t)current + (uint32_t)value);
+                case operation::mul:        return (SInt32)((uint32_t)current * (uint32_t)value);
+                case operation::div:        return value != 0 ? boost::make_optional((SInt32)(current / value)) : boost::none;
+                case operation::mod:        return value != 0 ? boost::make_optional((SInt32)(current % value)) : boost::none;
+                case operation::bit_and:    return (SInt32)((uint32_t)current & (uint32_t)value);
+                case operation::bit_or:     return (SInt32)((uint32_t)current | (uint32_t)value);
+                case operation::bit_xor:    return (SInt32)((uint32_t)current ^ (uint32_t)value);
+                default:                    return boost::none;
+                }
+            }
+
+            // division by zero follows IEEE, as fetchDivFlt does
+            inline boost::optional<Float32> compute(operation op, Float32 current, Float32 value) {
+                switch (op) {
+                case operation::set:        return value;
+                case operation::add:        return current + value;
+                case operation::mul:        return current * value;
+                case operation::div:        return current / value;
+                default:                    return boost::none;
+                }
+            }
+        }
+
+        /**
+         * Applies the @steps in order and returns the value each step has replaced (the default one for None), or none if any step fails:
+         * a path doesn't resolve, a value is neither None nor of type T, an operation doesn't fit T or an integer
+         * is divided by zero. A failed batch changes no values, though with @createMissingKeys the containers
+         * (and None items) it has created on the way stay. A None value is read as the @initial one
+         */
+        template<class T>
+        inline boost::optional<std::vector<T>> apply(object_base& target, const std::vector<step<T>>& steps,
+            const T& initial, bool createMissingKeys)
+        {
+            using internal_item_type = item::user2variant_t<T>;
+
+            // keeps the resolved containers in memory, even if some of them get retired meanwhile
+            util::epoch::guard pin;
+
+            struct resolved {
+                object_base* collection;
+                ca::key_variant key;
+            };
+
+            std::vector<resolved> targets;
+            targets.reserve(steps.size());
+            for (auto& s : steps) {
+                auto info = createMissingKeys ? ca::access_creative(target, s.path.c_str()) : ca::access_constant(target, s.path.c_str());
+                if (!info) {
+                    return boost::none;
+                }
+                targets.push_back(resolved{ &info->collection, std::move(info->key) });
+            }
+
+            std::vector<object_base*> collections;
+            collections.reserve(targets.size());
+            for (auto& t : targets) {
+                collections.push_back(t.collection);
+            }
+            std::sort(collections.begin(), collections.end());
+            collections.erase(std::unique(collections.begin(), collections.end()), collections.end());
+
+            std::deque<object_lock> locks; // the same order object_lock_pair follows
+            for (auto obj : collections) {
+                locks.emplace_back(obj);
+            }
+
+            // a dry run first: nothing is written until every step is known to succeed
+            std::vector<std::pair<item*, T>> pending;
+            pending.reserve(steps.size());
+            std::vector<T> previous;
+            previous.reserve(steps.size());
+
+            for (size_t i = 0; i < steps.size(); ++i) {
+                item* itm = ca::u_access_value(*targets[i].collection, targets[i].key);
+                if (!itm) {
+                    return boost::none;
+                }
+
+                auto written = std::find_if(pending.rbegin(), pending.rend(), [itm](const std::pair<item*, T>& p) { return p.first == itm; });
+
+                T current;
+                T replaced = default_value<T>(); // None is returned as the default value, like fetchAddInt does
+                if (written != pending.rend()) {
+                    current = replaced = written->second;
+                }
+                else if (itm->isNull()) {
+                    current = initial;
+                }
+                else if (auto asT = itm->get<internal_item_type>()) {
+                    current = replaced = (T)*asT;
+                }
+                else {
+                    return boost::none;
+                }
+
+                auto next = detail::compute(steps[i].op, current, steps[i].value);
+                if (!next) {
+                    return boost::none;
+                }
+
+                previous.push_back(replaced);
+                pending.emplace_back(itm, *next);
+            }
+
+            for (auto obj : collections) {
+                ca::u_value_exposed(*obj);
+            }
+            for (auto& p : pending) {
+                *p.first = p.second;
+            }
+
+            return previous;
+        }
+    }
+}
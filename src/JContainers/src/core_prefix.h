@@ -0,0 +1,38 @@
+#pragma once
+
+// Stands for SKSE's common/IPrefix.h in the jcontainers_core build (JC_CORE): the game-independent part of JContainers
+// compiled without SKSE, Windows or MSVC
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+typedef std::uint8_t    UInt8;
+typedef std::uint16_t   UInt16;
+typedef std::uint32_t   UInt32;
+typedef std::uint64_t   UInt64;
+typedef std::int8_t     SInt8;
+typedef std::int16_t    SInt16;
+typedef std::int32_t    SInt32;
+typedef std::int64_t    SInt64;
+typedef float           Float32;
+typedef double          Float64;
+
+// the log macros of SKSE's common/IDebugLog.h write to the JContainers log
+#define _MESSAGE(fmt, ...)      JC_log(fmt, ##__VA_ARGS__)
+#define _WARNING(fmt, ...)      JC_log("[Warning] " fmt, ##__VA_ARGS__)
+#define _ERROR(fmt, ...)        JC_log("[Error] " fmt, ##__VA_ARGS__)
+#define _FATALERROR(fmt, ...)   JC_log("[Fatal] " fmt, ##__VA_ARGS__)
+
+// the bounds-checked C functions (C11 Annex K) MSVC provides
+inline size_t strnlen_s(const char* str, size_t max) { return str ? strnlen(str, max) : 0; }
+
+template<size_t N>
+inline int sprintf_s(char (&buffer)[N], const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int written = vsnprintf(buffer, N, fmt, args);
+    va_end(args);
+    return written >= 0 && size_t(written) < N ? written : -1;
+}
@@ -16,6 +16,7 @@
 #include "util/singleton.h"
 #include "util/util.h"
 #include "util/istring.h"
+#include "util/profiling.h"
 #include "iarchive_with_blob.h"
 
 #include "object/object_context.h"
@@ -170,33 +171,46 @@ namespace domain_master {
             }
         };
 
-        auto read_from_stream(master& self, std::istream& stream) -> void {
+        auto read_from_stream(master& self, std::istream& source) -> void {
             //_context.read_from_stream(s);
 
-            stream.flags(stream.flags() | std::ios::binary);
+            source.flags(source.flags() | std::ios::binary);
 
 #       if 0
             std::ofstream file("dump", std::ios::binary | std::ios::out);
             std::copy(
-                std::istreambuf_iterator<char>(stream),
+                std::istreambuf_iterator<char>(source),
                 std::istreambuf_iterator<char>(),
                 std::ostreambuf_iterator<char>(file)
                 );
             file.close();
 #       endif
 
+            util::profiling::counting_streambuf counter{ source.rdbuf() };
+            std::istream stream{ &counter };
+
+            util::profiling::report report{ "load" };
+            util::profiling::report::attach attached{ report, counter };
+
             activity_stopper stopper{ self };
             {
                 // i have assumed that Skyrim devs are not idiots to run scripts in process of save game loading
                 //write_lock g(_mutex);
 
-                u_clearState(self);
+                {
+                    util::profiling::phase_scope p{ "clear_state" };
+                    u_clearState(self);
+                }
 
                 if (stream.peek() != std::istream::traits_type::eof()) {
 
                     try {
 
-                        auto hdr = header::read_from_stream(stream);
+                        header hdr;
+                        {
+                            util::profiling::phase_scope p{ "header" };
+                            hdr = header::read_from_stream(stream);
+                        }
                         bool isNotSupported = serialization_version::current < hdr.commonVersion
                             || hdr.commonVersion <= serialization_version::no_header;
 
@@ -214,6 +228,7 @@ namespace domain_master {
                             // (stream) -> [(name,context)]
 
                             if (hdr.commonVersion <= serialization_version::pre_dyn_form_watcher) {
+                                util::profiling::domain_scope d{ "default" };
                                 self.get_default_domain().load_data_in_old_way(archive);
                             }
                             else {
@@ -221,11 +236,23 @@ namespace domain_master {
                             }
                         }
 
-                        u_delete_inactive_domains(self);
-
-                        invoke_for_all(self, std::mem_fn(&context::u_postLoadInitializations));
-                        invoke_for_all(self, std::mem_fn(&context::u_applyUpdates), hdr.commonVersion);
-                        invoke_for_all(self, std::mem_fn(&context::u_postLoadMaintenance), hdr.commonVersion);
+                        {
+                            util::profiling::phase_scope p{ "delete_inactive_domains" };
+                            u_delete_inactive_domains(self);
+                        }
+                        {
+                            util::profiling::phase_scope p{ "post_load_initializations" };
+                            invoke_for_all(self, std::mem_fn(&context::u_postLoadInitializations));
+                        }
+                        {
+                            util::profiling::phase_scope p{ "apply_updates" };
+                            invoke_for_all(self, std::mem_fn(&context::u_applyUpdates), hdr.commonVersion);
+                        }
+                        {
+                            // the post-load maintenance is the garbage collection of every domain
+                            util::profiling::phase_scope p{ "garbage_collection" };
+                            invoke_for_all(self, std::mem_fn(&context::u_postLoadMaintenance), hdr.commonVersion);
+                        }
                     }
                     catch (const std::exception& exc) {
                         _FATALERROR("caught exception (%s) during archive load - '%s'",
@@ -249,22 +276,37 @@ namespace domain_master {
 
         }
 
-        auto write_to_stream(master& self, std::ostream& stream) -> void {
-            stream.flags(stream.flags() | std::ios::binary);
+        auto write_to_stream(master& self, std::ostream& destination) -> void {
+            destination.flags(destination.flags() | std::ios::binary);
+
+            util::profiling::counting_streambuf counter{ destination.rdbuf() };
+            std::ostream stream{ &counter };
+
+            util::profiling::report report{ "save" };
+            util::profiling::report::attach attached{ report, counter };
 
             activity_stopper s{ self };
             {
                 // we can also cleanup objects here
                 {
+                    util::profiling::phase_scope p{ "remove_expired_forms" };
                     self.get_form_observer().u_remove_expired_forms();
                 }
 
-                header::write_to_stream(stream);
-                boost::archive::binary_oarchive arch{ stream };
+                {
+                    util::profiling::phase_scope p{ "header" };
+                    header::write_to_stream(stream);
+                }
 
-                // [(name, domain)] -> stream
+                {
+                    boost::archive::binary_oarchive arch{ stream };
 
-                arch << self;
+                    // [(name, domain)] -> stream
+
+                    arch << self;
+                }
+
+                stream.flush();
 
                 u_print_stats(self);
             }
@@ -357,6 +399,35 @@ namespace domain_master {
             EXPECT_TRUE(m.active_domains_map().empty());
         }
 
+        TEST(master, save_load_report)
+        {
+            ::domain_master::master m;
+            m.get_default_domain().root(); // at least one JMap to account
+
+            std::stringstream stream;
+            m.write_to_stream(stream);
+
+            std::stringstream input{ stream.str() };
+            m.read_from_stream(input);
+
+            for (auto operation : { "save", "load" }) {
+                auto js = make_unique_ptr(json_loads(util::profiling::report::last_as_json(operation).c_str(), 0, nullptr), &json_decref);
+                ASSERT_TRUE(js != nullptr);
+
+                EXPECT_EQ((json_int_t)stream.str().size(), json_integer_value(json_object_get(js.get(), "bytes")));
+                EXPECT_TRUE(json_array_size(json_object_get(js.get(), "phases")) > 0);
+
+                auto phases = json_object_get(js.get(), "phases");
+                bool collected = false;
+                for (size_t i = 0; i < json_array_size(phases); ++i) {
+                    collected |= std::string("garbage_collection") == json_string_value(json_object_get(json_array_get(phases, i), "name"));
+                }
+                EXPECT_EQ(std::string("load") == operation, collected);
+                EXPECT_TRUE(json_object_get(json_object_get(js.get(), "domains"), "default") != nullptr);
+                EXPECT_TRUE(json_object_get(json_object_get(js.get(), "types"), "JMap") != nullptr);
+            }
+        }
+
         /*
         TEST(master, backward_compatibility)
         {
@@ -1,10 +1,11 @@
 #pragma once
 
-#include "boost\serialization\split_free.hpp"
-#include "boost\serialization\version.hpp"
-//#include "boost\serialization\optional.hpp"
+#include "boost/serialization/split_free.hpp"
+#include "boost/serialization/version.hpp"
+//#include "boost/serialization/optional.hpp"
 
 #include "util/istring_serialization.h"
+#include "util/profiling.h"
 
 #include "domains/domain_master.h"
 
@@ -13,23 +14,33 @@ namespace boost {
 
         template<class Archive>
         void save(Archive & arch, const ::domain_master::master & self, unsigned int version) {
-            arch << self.get_default_domain();
+            {
+                util::profiling::domain_scope d{ "default" };
+                arch << self.get_default_domain();
+            }
 
             uint32_t domain_count = self.active_domains_map().size();
             arch << domain_count;
 
             for (auto& pair : self.active_domains_map()) {
                 arch << *reinterpret_cast<std::string const*> (&pair.first);
+
+                util::profiling::domain_scope d{ pair.first.c_str() };
                 arch << *pair.second;
             }
 
+            util::profiling::phase_scope p{ "form_observer" };
             arch << self.get_form_observer();
         }
 
         template<class Archive>
         void load(Archive & archive, ::domain_master::master & self, unsigned int version) {
 
-            archive >> self.get_default_domain();
+            {
+                util::profiling::domain_scope d{ "default" };
+                archive >> self.get_default_domain();
+            }
+
             uint32_t domain_count = 0;
             archive >> domain_count;
 
@@ -37,9 +48,12 @@ namespace boost {
                 util::istring dom_name;
                 archive >> *reinterpret_cast<std::string*> (&dom_name);
                 auto& dom = self.get_or_create_domain_with_name(dom_name);
+
+                util::profiling::domain_scope d{ dom_name.c_str() };
                 archive >> dom;
             }
 
+            util::profiling::phase_scope p{ "form_observer" };
             archive >> self.get_form_observer();
         }
 
@@ -1,53 +1,80 @@
 #pragma once
 
-#include <concurrent_unordered_map.h> //See _SILENCE_CXX17_OLD_ALLOCATOR_MEMBERS_DEPRECATION_WARNING
-
 #include <atomic>
-#include <tuple>
 #include <assert.h>
-#include "boost/shared_ptr.hpp"
-#include "boost/smart_ptr/weak_ptr.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
 #include "boost/serialization/split_member.hpp"
 #include "boost/serialization/version.hpp"
-#include "boost/noncopyable.hpp"
 #include "boost/core/explicit_operator_bool.hpp"
 
 #include "util/spinlock.h"
 #include "util/stl_ext.h"
+#include "util/bounded_queue.h"
 
 #include "rw_mutex.h"
-#include "form_id.h"
+#include "skse/skse.h"
+#include "forms/form_id.h"
+#include "forms/form_ref.h"
+#include "forms/form_table.h"
 
 class TESForm;
 
 namespace forms {
 
-    class form_observer;
-    class form_entry;
-
-    using form_entry_ref = boost::shared_ptr < form_entry > ;
-
     class form_observer {
-    private:
-        using weak_entry = boost::weak_ptr<form_entry>;
-        using watched_forms_t = concurrency::concurrent_unordered_map < FormId, weak_entry >;
+    public:
+        typedef std::function<void(std::function<void()>)> executor;
 
-        watched_forms_t _watched_forms;
+    private:
+        // the table shares entries with form_refs. An entry referenced by the table only gets removed
+        // by the table itself or by @u_remove_expired_forms
+        form_table _watched_forms;
+
+        struct queued_deletion {
+            FormId id = FormId::Zero;
+            uint32_t stamp = 0;
+        };
+
+        // batching mode: the deleted forms wait here until a posted job (or a save or load) flags them
+        std::unique_ptr<util::bounded_queue<queued_deletion>> _deleted_forms;
+        std::atomic<uint32_t> _deletion_stamp{ 0 };    // advanced by each queued deletion
+        executor _post;
+        std::atomic<bool> _flush_scheduled{ false };
+        // held by a flush and by the not threadsafe functions, which the posted jobs may otherwise run along with
+        mutable std::mutex _flush_mutex;
+
+        void mark_deleted(FormId formId);
+        void u_flush_deleted_forms();
 
     public:
 
+        static const size_t deleted_forms_capacity = 16384;
+
         form_observer() = default;
+        ~form_observer();
 
         void on_form_deleted(FormHandle fId);
-        form_entry_ref watch_form(FormId fId);
+        form_ref watch_form(FormId fId);
+
+        // Batching mode: @on_form_deleted only queues the form and @post-s a job which flags the queued forms
+        // in one go, the form_refs see a queued form alive until then. Save and load flag them first. A form
+        // watched again after its deletion was queued (a new form took the id) isn't flagged.
+        // Null @post turns the mode off. Not threadsafe: no forms may be deleted meanwhile.
+        // The @post-ed jobs must not outlive the observer
+        void set_deletion_batching(executor post);
+        void flush_deleted_forms();
 
         // Not threadsafe part of API:
 
         void u_clearState() {
-            _watched_forms.clear();
+            std::lock_guard<std::mutex> g{ _flush_mutex };
+            u_flush_deleted_forms();
+            _watched_forms.u_clear();
         }
 
-        size_t u_forms_count() const { return _watched_forms.size(); }
+        size_t u_forms_count() const { return _watched_forms.u_count(); }
         void u_remove_expired_forms();
         void u_print_status() const;
 
@@ -60,71 +87,6 @@ namespace forms {
         template<class Archive> void load(Archive & ar, const unsigned int version);
     };
 
-    class form_ref {
-        form_entry_ref _watched_form;
-
-    public:
-
-        form_ref(form_entry_ref&& entry) : _watched_form(std::move(entry)) {}
-        explicit form_ref(const form_entry_ref& entry) : _watched_form(entry) {}
-
-        form_ref& operator = (form_ref&& entry) {
-            if (this != &entry) {
-                _watched_form = std::move(entry._watched_form);
-            }
-            return *this;
-        }
-
-        form_ref() = default;
-        form_ref(const form_ref &) = default;
-        form_ref& operator = (const form_ref &) = default;
-
-        form_ref(FormId id, form_observer& watcher);
-        form_ref(const TESForm& form, form_observer& watcher);
-
-        static form_ref make_expired(FormId formId);
-
-        // Special constructor - to load pre v3.3 data
-        enum load_old_id_t { load_old_id };
-        explicit form_ref(FormId oldId, form_observer& watcher, load_old_id_t);
-
-        bool is_not_expired() const;
-        bool is_expired() const { return !is_not_expired(); }
-
-        FormId get() const;
-        FormId get_raw() const;
-
-        bool operator!() const BOOST_NOEXCEPT { return is_expired(); }
-        BOOST_EXPLICIT_OPERATOR_BOOL_NOEXCEPT();
-
-        void swap(form_ref& other) {
-            static_assert(sizeof(other) == sizeof(_watched_form),
-                "ensures that no additional fields were added");
-            _watched_form.swap(other._watched_form);
-        }
-
-        struct stable_less_comparer;
-
-        friend class boost::serialization::access;
-        BOOST_SERIALIZATION_SPLIT_MEMBER();
-
-        template<class Archive> void save(Archive & ar, const unsigned int version) const;
-        template<class Archive> void load(Archive & ar, const unsigned int version);
-    };
-
-    // Implements stable 'less than' form_ref comparison
-    // Note that the comparison is not as stable as before - due to is_expired() function which
-    // may start returning False once a form_ref gets expired.
-    // And in a result of this a map container of <form_ref, value> keys containing expired and non-expired form_ref-keys 
-    // (with equal raw form ids) may start contain equal two keys and may act weird
-    struct form_ref::stable_less_comparer {
-        template<class FormRef1, class FormRef2>
-        bool operator () (const FormRef1& left, const FormRef2& right) const {
-            return std::make_tuple(left.get_raw(), left.is_expired())
-                < std::make_tuple(right.get_raw(), right.is_expired());
-        }
-    };
-
     // It's lightweight alternative to form_ref to temporarily hold forms
     // why lightweight? form_ref constructor accesses form_observer, which is costly
     class form_ref_lightweight {
@@ -159,7 +121,7 @@ namespace forms {
 
     // "Stupid" form_ref comparison functions:
     // the functions don't care whether the @form_refs are really equal or not -
-    // really equal form_refs have equal @_watched_form fields
+    // really equal form_refs point to the same form_entry
     // The comparison is NOT stable
     namespace comp {
         template<class FormRef1, class FormRef2>
@@ -227,7 +189,7 @@ namespace collections {
 
     template<class Context>
     inline form_ref_lightweight make_lightweight_form_ref(const TESForm* form, Context& context) {
-        return form_ref_lightweight{ form ? util::to_enum<FormId>(form->formID) : FormId::Zero, context._form_watcher };
+        return form_ref_lightweight{ form ? skse::form_id(*form) : FormId::Zero, context._form_watcher };
     }
 
 }
@@ -1,18 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <assert.h>
 #include <inttypes.h>
 #include <map>
 #include <tuple>
 #include <mutex>
+#include <thread>
+#include <vector>
 
-#include <boost/smart_ptr/make_shared_object.hpp>
 #include <boost/range.hpp>
 
 #include "boost/serialization/version.hpp"
 #include "boost/serialization/split_member.hpp"
-#include <boost/serialization/shared_ptr.hpp>
-#include <boost/serialization/weak_ptr.hpp>
+#include <boost/serialization/tracking.hpp>
 #include <boost/serialization/unordered_map.hpp>
 
 #include "skse/skse.h"
@@ -33,97 +34,151 @@ namespace forms {
         //JC_log(fmt, std::forward<Params>(ps) ...);
     }
 
-    class form_entry : public boost::noncopyable {
+    uint32_t form_entry_table::u_allocate() {
+        if (_free_head) {
+            uint32_t index = _free_head;
+            _free_head = at(index)._next_free;
+            return index;
+        }
+        if (_count == chunk_size * max_chunks) {
+            return 0;
+        }
+        if (_count % chunk_size == 0 || _count == 1) {
+            _chunks[_count / chunk_size].store(new form_entry[chunk_size], std::memory_order_release);
+        }
+        return _count++;
+    }
 
-        FormId _handle = FormId::Zero;
-        std::atomic<bool> _deleted = false;
-        // remember whether a form handle was retained or not
-        // to not release it if the handle wasn't be previously retained (for ex. handle's object was not loaded)
-        bool _is_handle_retained = false;
+    uint32_t form_entry_table::allocate(FormId handle, bool deleted, bool handle_was_retained) {
+        uint32_t index = 0;
+        {
+            guard g{ s_instance._lock };
+            index = s_instance.u_allocate();
+        }
+        jc_assert_msg(index, "form_entry_table is full");
 
-    public:
+        if (index) {
+            auto& entry = at(index);
+            entry._handle = handle;
+            entry._deleted = deleted;
+            entry._is_handle_retained = handle_was_retained;
+        }
+        else if (!deleted && handle_was_retained) {
+            skse::release_handle(handle);
+        }
+        return index;
+    }
 
-        form_entry(FormId handle, bool deleted, bool handle_was_retained)
-            : _handle(handle)
-            , _deleted(deleted)
-            , _is_handle_retained(handle_was_retained)
-        {}
+    void form_entry_table::free(uint32_t index) {
+        auto& entry = at(index);
+        if (!entry.u_is_deleted() && entry._is_handle_retained) {
+            //log("form_entry releases %X", _handle);
+            skse::release_handle(entry._handle);
+        }
 
-        form_entry() = default;
+        guard g{ _lock };
+        entry._next_free = _free_head;
+        _free_head = index;
+    }
 
-        static form_entry_ref make(FormId handle) {
-            //log("form_entry retains %X", handle);
+    form_ref form_entry::make(FormId handle) {
+        //log("form_entry retains %X", handle);
 
-            return boost::make_shared<form_entry>(
-                handle,
-                false,
-                skse::try_retain_handle(handle));
-        }
+        return form_ref{ form_entry_table::allocate(
+            handle,
+            false,
+            skse::try_retain_handle(handle)) };
+    }
 
-        static form_entry_ref make_expired(FormId handle) {
-            return boost::make_shared<form_entry>(handle, true, false);
-        }
+    form_ref form_entry::make_expired(FormId handle) {
+        return form_ref{ form_entry_table::allocate(handle, true, false) };
+    }
 
-        ~form_entry() {
-            if (!u_is_deleted() && _is_handle_retained) {
-                //log("form_entry releases %X", _handle);
-                skse::release_handle(_handle);
-            }
-        }
+    template<class Archive> void form_entry::save(Archive & ar, const unsigned int version) const {
+        ar << util::to_integral_ref(_handle);
+        ar << long (_deleted);
+    }
 
-        FormId id() const { return _handle; }
+    template<class Archive> void form_entry::load(Archive & ar, const unsigned int version) {
+        long tmp_deleted;
+        ar >> util::to_integral_ref(_handle);
+        ar >> tmp_deleted;
+        _deleted = tmp_deleted;
 
-        bool is_deleted() const {
-            return _deleted.load(std::memory_order_acquire);
-        }
+        if (u_is_deleted() == false) {
+            _handle = skse::resolve_handle(_handle);
 
-        void set_deleted() {
-            _deleted.store(true, std::memory_order_release);
+            if (_handle != FormId::Zero) {
+                _is_handle_retained = skse::try_retain_handle(_handle);
+            }
+            else {
+                u_set_deleted();
+            }
         }
+    }
 
-        bool u_is_deleted() const {
-            return _deleted;
-        }
-        void u_set_deleted() {
-            _deleted = true;
-        }
+    // The archive creates an entry for each loaded form_entry pointer. The entries get moved into
+    // the form_entry_table. The loaded ones are kept until the archive is destroyed - the archive
+    // may return the same pointer again, and a new entry must not be allocated at its address meanwhile
+    struct loaded_form_entries {
+        std::map<const form_entry*, form_ref> moved;
+        std::vector<std::unique_ptr<form_entry>> loaded;
+    };
 
-        friend class boost::serialization::access;
-        BOOST_SERIALIZATION_SPLIT_MEMBER();
+    // Reads and writes a form_entry pointer exactly the way boost::shared_ptr<form_entry> did
+    // (a tracked pointer, the same class traits), so the format of the saves remains the same
+    struct form_entry_pointer {
+        form_ref ref;
 
         template<class Archive> void save(Archive & ar, const unsigned int version) const {
-            ar << util::to_integral_ref(_handle);
-            ar << long (_deleted);
+            const form_entry* p = ref.entry();
+            ar << p;
         }
 
         template<class Archive> void load(Archive & ar, const unsigned int version) {
-            long tmp_deleted;
-            ar >> util::to_integral_ref(_handle);
-            ar >> tmp_deleted;
-            _deleted = tmp_deleted;
+            static char loaded_form_entries_id;
 
-            if (u_is_deleted() == false) {
-                _handle = skse::resolve_handle(_handle);
+            form_entry* p = nullptr;
+            ar >> p;
+            if (!p) {
+                ref = form_ref();
+                return;
+            }
 
-                if (_handle != FormId::Zero) {
-                    _is_handle_retained = skse::try_retain_handle(_handle);
-                }
-                else {
-                    u_set_deleted();
-                }
+            auto& helper = ar.template get_helper<loaded_form_entries>(&loaded_form_entries_id);
+            auto& moved = helper.moved[p];
+            if (!moved.index()) { // loaded for the first time
+                helper.loaded.emplace_back(p);
+                moved = form_ref{ form_entry_table::allocate(p->id(), p->u_is_deleted(), p->_is_handle_retained) };
             }
+            ref = moved;
         }
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER();
     };
 
-    void form_observer::u_remove_expired_forms() {
-        auto hashmap_eraser = [](watched_forms_t& cnt, const watched_forms_t::const_iterator& itr) {
-            return cnt.unsafe_erase(itr);
-        };
+    // pre v3.3 form_observer format stored boost::weak_ptr<form_entry>
+    struct form_entry_weak_pointer {
+        form_entry_pointer pointer;
+
+        template<class Archive> void serialize(Archive & ar, const unsigned int version) {
+            ar & pointer;
+        }
+    };
+}
 
-        util::tree_erase_if(_watched_forms, [](const watched_forms_t::value_type& pair) {
-            return pair.second.expired();
-        },
-            hashmap_eraser);
+BOOST_CLASS_VERSION(forms::form_entry_pointer, 1);
+BOOST_CLASS_TRACKING(forms::form_entry_pointer, boost::serialization::track_never);
+
+namespace forms {
+
+    void form_observer::u_remove_expired_forms() {
+        std::lock_guard<std::mutex> g{ _flush_mutex };
+        u_flush_deleted_forms();
+        // the entries referenced by the table only
+        _watched_forms.u_remove_if([](const form_ref& ref) {
+            return ref.entry()->use_count() == 1;
+        });
     }
 
     void form_observer::u_print_status() const
@@ -131,32 +186,23 @@ namespace forms {
         uint32_t count_of_one_user = 0;
         uint32_t dyn_form_count = 0;
 
-        for (auto& pair : _watched_forms) {
-            if (!pair.second.expired()) {
-                log("%" PRIX32 " : %u", pair.first, pair.second.use_count());
-                if (pair.second.use_count() == 1) {
-                    ++count_of_one_user;
-                }
-                if (!fh::is_static(pair.first)) {
-                    ++dyn_form_count;
-                }
+        _watched_forms.u_for_each([&](const form_ref& ref) {
+            const uint32_t use_count = ref.entry()->use_count() - 1; // minus the table
+            log("%" PRIX32 " : %u", ref.get_raw(), use_count);
+            if (use_count == 1) {
+                ++count_of_one_user;
             }
-        }
+            if (!fh::is_static(ref.get_raw())) {
+                ++dyn_form_count;
+            }
+        });
 
-        log("total %u", _watched_forms.size());
+        log("total %u", _watched_forms.u_count());
         log("count_of_one_user %u", count_of_one_user);
         log("dyn_form_count %u", dyn_form_count);
 
     }
 
-    namespace {
-
-        static boost::detail::spinlock & spinlock_for(FormId formId) {
-            using spinlock_pool = boost::detail::spinlock_pool < 'DyFW' > ;
-            return spinlock_pool::spinlock_for(reinterpret_cast<void*>(formId));
-        }
-    }
-
     void form_observer::on_form_deleted(FormHandle handle)
     {
         // already failed, there are plenty of any kind of objects that are deleted every moment, even during initial splash screen
@@ -173,69 +219,139 @@ namespace forms {
         ///log("on_form_deleted: %" PRIX64, handle);
 
         auto formId = fh::form_handle_to_id(handle);
-        {
-            // Since it's impossible that two threads will delete the same form simultaneosly
-            // we can skip some thread safe stuff
-            auto itr = _watched_forms.find(formId);
-            if (itr != _watched_forms.end()) {
-
-                auto watched = itr->second.lock();
-
-                if (watched) {
-                    watched->set_deleted();
-                    {
-                        // the only unsafe piece of code here
-                        std::lock_guard<boost::detail::spinlock> guard{ spinlock_for(formId) };
-                        itr->second.reset();
-                    }
-                    log("flagged form-entry %" PRIX32 " as deleted", formId);
+
+        if (_deleted_forms) {
+            const uint32_t stamp = _deletion_stamp.fetch_add(1, std::memory_order_acq_rel) + 1;
+            if (_deleted_forms->try_push(queued_deletion{ formId, stamp })) {
+                if (!_flush_scheduled.load(std::memory_order_relaxed) && !_flush_scheduled.exchange(true, std::memory_order_acq_rel)) {
+                    _post([this]() {
+                        _flush_scheduled.store(false, std::memory_order_release);
+                        flush_deleted_forms();
+                    });
                 }
+                return;
+            }
+            // the queue is full: flags the form right away, the order of the deletions doesn't matter
+        }
+
+        mark_deleted(formId);
+    }
+
+    void form_observer::mark_deleted(FormId formId) {
+        form_ref watched; // releases the table's reference out of the lock
+        _watched_forms.update(formId, [&watched](form_ref& slot) {
+            watched = std::move(slot);
+            if (watched.entry()) {
+                watched.entry()->set_deleted();
             }
+        });
+
+        if (watched.entry()) {
+            log("flagged form-entry %" PRIX32 " as deleted", formId);
+        }
+    }
+
+    void form_observer::flush_deleted_forms() {
+        if (_deleted_forms) {
+            std::lock_guard<std::mutex> g{ _flush_mutex };
+            u_flush_deleted_forms();
         }
     }
 
-    template<class Archive, class Collection, class ElementSaver>
-    void save_collection(Archive& archive, const Collection& collection, ElementSaver&& saver) {
-        uint32_t count = collection.size();
-        archive << count;
-        for (const auto& pair : collection) {
-            saver(archive, pair);
+    void form_observer::u_flush_deleted_forms() {
+        if (!_deleted_forms) {
+            return;
+        }
+
+        std::vector<queued_deletion> deletions;
+        queued_deletion deletion;
+        while (_deleted_forms->try_pop(deletion)) {
+            deletions.push_back(deletion);
+        }
+        if (deletions.empty()) {
+            return;
+        }
+        const uint32_t queued = static_cast<uint32_t>(deletions.size());
+
+        // the latest deletion of each form
+        std::sort(deletions.begin(), deletions.end(), [](const queued_deletion& l, const queued_deletion& r) {
+            return l.id != r.id ? l.id < r.id : (int32_t)(l.stamp - r.stamp) < 0;
+        });
+        deletions.erase(deletions.begin(), std::unique(deletions.rbegin(), deletions.rend(), [](const queued_deletion& l, const queued_deletion& r) {
+            return l.id == r.id;
+        }).base());
+
+        std::vector<FormId> ids;
+        ids.reserve(deletions.size());
+        for (auto& d : deletions) {
+            ids.push_back(d.id);
+        }
+
+        std::vector<form_ref> watched; // releases the table's references out of the locks
+        _watched_forms.update_batch(ids, [&watched, &deletions](form_ref& slot) {
+            if (!slot.entry()) {
+                return;
+            }
+            auto itr = std::lower_bound(deletions.begin(), deletions.end(), slot.get_raw(), [](const queued_deletion& d, FormId id) {
+                return d.id < id;
+            });
+            // the form watched since the deletion was queued is a new one with the same id
+            if ((int32_t)(slot.entry()->u_watched_at() - itr->stamp) < 0) {
+                slot.entry()->set_deleted();
+                watched.push_back(std::move(slot));
+            }
+        });
+
+        log("flagged %u of %u queued form-entries as deleted", (uint32_t)watched.size(), queued);
+    }
+
+    void form_observer::set_deletion_batching(executor post) {
+        flush_deleted_forms();
+
+        if (post) {
+            _deleted_forms.reset(new util::bounded_queue<queued_deletion>(deleted_forms_capacity));
+            _post = std::move(post);
+        }
+        else {
+            _deleted_forms.reset();
+            _post = nullptr;
         }
     }
-    template<class Archive, class Collection, class ElementLoader>
-    void load_collection(Archive& archive, Collection& collection, ElementLoader&& loader) {
-        uint32_t count = 0;
-        archive >> count;
 
-        while (count > 0) {
-            --count;
-            loader(archive, collection);
+    form_observer::~form_observer() {
+        if (_deleted_forms) {
+            set_deletion_batching(nullptr);
         }
     }
 
     template<>
     void form_observer::load(boost::archive::binary_iarchive & ar, const unsigned int version) {
 
-        switch (version) {
-        case 3:
-            load_collection(ar, _watched_forms, [&ar](boost::archive::binary_iarchive& ar, decltype(_watched_forms)& collection) {
-                form_entry_ref entry;
-                ar >> entry;
+        auto insert = [this](form_ref& entry) {
+            if (entry) {
+                _watched_forms.update(entry.get_raw(), [&entry](form_ref& slot) { slot = std::move(entry); });
+            }
+        };
 
-                if (entry && !entry->is_deleted()) {
-                    collection[entry->id()] = std::move(entry);
-                }
-            });
+        switch (version) {
+        case 3: {
+            uint32_t count = 0;
+            ar >> count;
+
+            while (count > 0) {
+                --count;
+                form_entry_pointer loaded;
+                ar >> loaded;
+                insert(loaded.ref);
+            }
+        }
             break;
         case 2:{
-            std::unordered_map<FormId, boost::weak_ptr<form_entry> > oldCnt;
+            std::unordered_map<FormId, form_entry_weak_pointer> oldCnt;
             ar >> oldCnt;
 
             for (auto& pair : oldCnt) {
-                form_entry_ref entry = pair.second.lock();
-                if (entry && !entry->is_deleted()) {
-                    _watched_forms[entry->id()] = std::move(entry);
-                }
+                insert(pair.second.pointer.ref);
             }
         }
             break;
@@ -247,49 +363,48 @@ namespace forms {
 
     template<>
     void form_observer::save(boost::archive::binary_oarchive & ar, const unsigned int version) const {
+        std::lock_guard<std::mutex> g{ _flush_mutex };
+
+        uint32_t count = _watched_forms.u_count();
+        ar << count;
 
-        save_collection(ar, _watched_forms, [&ar](boost::archive::binary_oarchive& ar, const decltype(_watched_forms)::value_type& pair) {
-            auto entry = pair.second.lock();
+        _watched_forms.u_for_each([&ar](const form_ref& ref) {
+            // entries referenced by the table only are written as null
+            const form_entry_pointer entry{ ref.entry()->use_count() > 1 ? ref : form_ref() };
             ar << entry;
         });
     }
 
-    form_entry_ref form_observer::watch_form(FormId fId)
+    form_ref form_observer::watch_form(FormId fId)
     {
         if (fId == FormId::Zero) {
-            return nullptr;
+            return form_ref();
         }
 
-        {
-
-            auto itr = _watched_forms.find(fId);
-
-            std::lock_guard<boost::detail::spinlock> guard{ spinlock_for(fId) };
+        // the deletions queued so far don't flag the form watched now
+        const uint32_t stamp = _deletion_stamp.load(std::memory_order_acquire);
 
-            if (itr != _watched_forms.end()) {
-                auto watched = itr->second.lock();
-                if (!watched || watched->is_deleted()) {
-                    // form-entry and real form has been deleted (recently)
-                    // watch the form again, create entry, assuming that a new form with such ID exists
+        form_ref result;
+        _watched_forms.update(fId, [&](form_ref& watched) {
+            if (!watched) {
+                // a new entry or the form-entry and real form has been deleted (recently)
+                // watch the form again, create entry, assuming that a new form with such ID exists
 
-                    // this code assumes that @watch_form tries to watch real existing form
-                    // rather than the one from JSON
-                    itr->second = watched = form_entry::make(fId);
+                // this code assumes that @watch_form tries to watch real existing form
+                // rather than the one from JSON
+                watched = form_entry::make(fId);
 
-                    log("queried, re-created form-entry %" PRIX32, fId);
-                }
-                else {
-                    log("queried form-entry %" PRIX32, fId);
-                }
-                return watched;
+                log("queried, created form-entry %" PRIX32, fId);
             }
             else {
-                auto entry_ref = form_entry::make(fId);
-                std::pair<watched_forms_t::iterator, bool> pair = _watched_forms.insert(watched_forms_t::value_type{ fId, entry_ref });
-                log("queried, created new form-entry %" PRIX32, fId);
-                return pair.first->second.lock();
+                log("queried form-entry %" PRIX32, fId);
             }
-        }
+            if (watched.entry()) {
+                watched.entry()->u_set_watched_at(stamp);
+            }
+            result = watched;
+        });
+        return result;
     }
 
     struct lock_or_fail {
@@ -308,50 +423,30 @@ namespace forms {
     ////////////////////////////////////////
 
     form_ref::form_ref(FormId id, form_observer& watcher)
-        : _watched_form(watcher.watch_form(id))
+        : form_ref(watcher.watch_form(id))
     {
     }
 
     form_ref::form_ref(const TESForm& form, form_observer& watcher)
-        : _watched_form(watcher.watch_form(util::to_enum<FormId>(form.formID)))
+        : form_ref(watcher.watch_form(skse::form_id(form)))
     {
     }
 
     form_ref::form_ref(FormId oldId, form_observer& watcher, load_old_id_t)
-        : _watched_form(watcher.watch_form(skse::resolve_handle(oldId)))
+        : form_ref(watcher.watch_form(skse::resolve_handle(oldId)))
     {
     }
 
     form_ref form_ref::make_expired(FormId formId) {
-        auto entry = form_entry::make_expired(formId);
-        return form_ref{ entry };
-    }
-
-    //////////////////
-
-    bool form_ref::is_not_expired() const {
-        return _watched_form && !_watched_form->is_deleted();
-    }
-
-    FormId form_ref::get() const {
-        return is_not_expired() ? _watched_form->id() : FormId::Zero;
-    }
-
-    FormId form_ref::get_raw() const {
-        return _watched_form ? _watched_form->id() : FormId::Zero;
+        return form_entry::make_expired(formId);
     }
 
     template<class Archive>
     void form_ref::save(Archive & ar, const unsigned int version) const
     {
         // optimization: if the form was deleted (is_not_expired is false) - write null instead
-
-        if (is_not_expired())
-            ar << _watched_form;
-        else {
-            decltype(_watched_form) fake;
-            ar << fake;
-        }
+        const form_entry_pointer entry{ is_not_expired() ? *this : form_ref() };
+        ar << entry;
     }
 
     template<class Archive>
@@ -369,7 +464,7 @@ namespace forms {
 
             if (!expired) {
                 auto& watcher = hack::iarchive_with_blob::from_base_get<collections::tes_context>(ar)._form_watcher;
-                _watched_form = watcher.watch_form(id);
+                *this = watcher.watch_form(id);
             }
             break;
         }
@@ -382,17 +477,22 @@ namespace forms {
             ar >> expired;
 
             if (!expired) {
-                ar >> _watched_form;
+                form_entry_pointer entry;
+                ar >> entry;
+                *this = std::move(entry.ref);
             }
             else {
                 auto& watcher = hack::iarchive_with_blob::from_base_get<collections::tes_context>(ar)._form_watcher;
-                _watched_form = watcher.watch_form(id);
+                *this = watcher.watch_form(id);
             }
             break;
         }
-        case 2:
-            ar >> _watched_form;
+        case 2: {
+            form_entry_pointer entry;
+            ar >> entry;
+            *this = std::move(entry.ref);
             break;
+        }
         default:
             assert(false);
             break;
@@ -451,22 +551,181 @@ namespace forms {
             }
         }
 
-/*
         TEST(form_observer, u_remove_expired_forms){
             form_observer watcher;
 
             const auto fid = util::to_enum<FormId>(0xff000014);
+            {
+                form_ref ref{ fid, watcher };
+                EXPECT_EQ(2, ref.entry()->use_count()); // and the table
 
-            auto entry = watcher.watch_form(fid);
-            EXPECT_TRUE(watcher.u_forms_count() == 1);
-            EXPECT_NOT_NIL(entry.get());
+                watcher.u_remove_expired_forms();
+                EXPECT_EQ(1, watcher.u_forms_count());
+            }
+            watcher.u_remove_expired_forms();
+            EXPECT_EQ(0, watcher.u_forms_count());
 
+            form_ref ref{ fid, watcher };
             watcher.on_form_deleted(fh::form_id_to_handle(fid));
             watcher.u_remove_expired_forms();
 
-            EXPECT_TRUE(watcher.u_forms_count() == 0);
-            EXPECT_TRUE(entry->is_deleted());
-        }*/
+            EXPECT_EQ(0, watcher.u_forms_count());
+            EXPECT_TRUE(ref.is_expired());
+            EXPECT_EQ(1, ref.entry()->use_count());
+        }
+
+        TEST(form_observer, lookup_drops_unused_entries)
+        {
+            form_observer watcher;
+            for (uint32_t i = 0; i < 10000; ++i) {
+                form_ref{ util::to_enum<FormId>(0xff000000 | i), watcher };
+            }
+            // no one references the entries, the lookups which pass them by drop them
+            for (uint32_t i = 0; i < 10000; ++i) {
+                form_ref{ util::to_enum<FormId>(0xff100000 | i), watcher };
+            }
+            EXPECT_LT(watcher.u_forms_count(), 20000u);
+
+            form_ref kept{ util::to_enum<FormId>(0xff000001), watcher };
+            watcher.u_remove_expired_forms();
+            EXPECT_EQ(1, watcher.u_forms_count());
+            EXPECT_TRUE(kept == form_ref(util::to_enum<FormId>(0xff000001), watcher));
+        }
+
+        TEST(form_observer, concurrent_perft)
+        {
+            const int thread_count = 8;
+            const uint32_t forms_per_thread = 200000;
+
+            form_observer watcher;
+            util::do_with_timing("form_observer watch_form/on_form_deleted, 8 threads", [&]() {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < thread_count; ++t) {
+                    threads.emplace_back([&watcher, t, forms_per_thread]() {
+                        std::vector<form_ref> held;
+                        held.reserve(forms_per_thread / 4);
+                        for (uint32_t i = 0; i < forms_per_thread; ++i) {
+                            const auto fid = util::to_enum<FormId>(0xff000000 | ((i * 31 + t) % 50000));
+                            form_ref ref{ fid, watcher };
+                            if (i % 4 == 0) {
+                                held.push_back(std::move(ref));
+                            }
+                            if (i % 16 == t) {
+                                watcher.on_form_deleted(fh::form_id_to_handle(fid));
+                            }
+                        }
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            });
+        }
+
+        TEST(form_observer, batched_deletion)
+        {
+            std::vector<std::function<void()>> posted;
+            form_observer watcher;
+            watcher.set_deletion_batching([&posted](std::function<void()> job) { posted.push_back(std::move(job)); });
+
+            const auto fid = util::to_enum<FormId>(0xff000014);
+            const auto other = util::to_enum<FormId>(0xff000015);
+            form_ref ref{ fid, watcher }, other_ref{ other, watcher };
+
+            watcher.on_form_deleted(fh::form_id_to_handle(fid));
+            watcher.on_form_deleted(fh::form_id_to_handle(fid));
+            watcher.on_form_deleted(fh::form_id_to_handle(other));
+            EXPECT_EQ(1, posted.size());                // a single job flags all three
+            EXPECT_TRUE(ref.is_not_expired());          // queued only, a read has no side effects
+
+            for (auto& job : posted) {
+                job();
+            }
+            posted.clear();
+            EXPECT_TRUE(ref.is_expired());
+            EXPECT_TRUE(other_ref.is_expired());
+
+            // the id of the deleted form is taken by a new form
+            watcher.on_form_deleted(fh::form_id_to_handle(fid));
+            EXPECT_EQ(1, posted.size());
+            form_ref reused{ fid, watcher };
+            posted.front()();
+            EXPECT_TRUE(reused.is_not_expired());
+            EXPECT_TRUE(reused != ref);
+
+            // the same, but the queued deletion finds the old entry still alive
+            const auto third = util::to_enum<FormId>(0xff000016);
+            form_ref third_ref{ third, watcher };
+            watcher.on_form_deleted(fh::form_id_to_handle(third));
+            form_ref third_reused{ third, watcher };
+            EXPECT_TRUE(third_reused == third_ref);
+            posted.back()();
+            posted.clear();
+            EXPECT_TRUE(third_reused.is_not_expired());
+
+            // more deletions than the queue holds
+            std::vector<form_ref> refs;
+            for (uint32_t i = 0; i < form_observer::deleted_forms_capacity * 2; ++i) {
+                refs.emplace_back(util::to_enum<FormId>(0xff100000 | i), watcher);
+            }
+            for (auto& r : refs) {
+                watcher.on_form_deleted(fh::form_id_to_handle(r.get_raw()));
+            }
+            watcher.u_remove_expired_forms();           // flags the queued forms, as the save does
+            EXPECT_TRUE(std::all_of(refs.begin(), refs.end(), [](const form_ref& r) { return r.is_expired(); }));
+            EXPECT_EQ(2, watcher.u_forms_count());      // @reused and @third_reused
+        }
+
+        // the time the game's thread spends in on_form_deleted during a burst of deletions, the posted flush runs after it
+        TEST(form_observer, batched_deletion_perft)
+        {
+            const uint32_t form_count = 100000;
+            const uint32_t burst = form_observer::deleted_forms_capacity - 1;
+
+            for (bool batching : { false, true }) {
+                std::vector<std::function<void()>> posted;
+                form_observer watcher;
+                if (batching) {
+                    watcher.set_deletion_batching([&posted](std::function<void()> job) { posted.push_back(std::move(job)); });
+                }
+
+                std::vector<form_ref> refs;
+                for (uint32_t i = 0; i < form_count; ++i) {
+                    refs.emplace_back(util::to_enum<FormId>(0xff000000 | i), watcher);
+                }
+
+                util::do_with_timing(batching ? "on_form_deleted burst, batching" : "on_form_deleted burst", [&]() {
+                    for (uint32_t i = 0; i < burst; ++i) {
+                        watcher.on_form_deleted(fh::form_id_to_handle(util::to_enum<FormId>(0xff000000 | (i * 7919 % form_count))));
+                    }
+                });
+
+                for (auto& job : posted) {
+                    job();
+                }
+                EXPECT_EQ(form_count - burst, (uint32_t)std::count_if(refs.begin(), refs.end(), [](const form_ref& r) { return r.is_not_expired(); }));
+            }
+        }
+
+        TEST(forms, form_map_perft)
+        {
+            form_observer watcher;
+            std::map<form_ref, int, form_ref::stable_less_comparer> forms;
+            for (uint32_t i = 0; i < 10000; ++i) {
+                forms.emplace(form_ref{ util::to_enum<FormId>(0xff000000 | i), watcher }, i);
+            }
+
+            util::do_with_timing("form_ref keyed map lookups and copies", [&]() {
+                size_t found = 0;
+                for (int repeat = 0; repeat < 100; ++repeat) {
+                    for (auto& pair : forms) {
+                        form_ref copy = pair.first;
+                        found += forms.count(copy);
+                    }
+                }
+                EXPECT_EQ(100 * forms.size(), found);
+            });
+        }
 
         // lookup with a non-expired form-ref ID 0x14 to a list containing expired form-ref (0x14) should fail
         TEST(forms, bug_1)
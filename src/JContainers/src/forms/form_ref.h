@@ -0,0 +1,219 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include "boost/serialization/split_member.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/core/explicit_operator_bool.hpp"
+
+#include "forms/form_id.h"
+
+class TESForm;
+
+namespace forms {
+
+    class form_observer;
+    class form_ref;
+
+    // A watched form: its id, deleted flag and the count of references to it (form_refs and the form_observer's table).
+    // The entries live in the form_entry_table
+    class form_entry : public boost::noncopyable {
+
+        FormId _handle = FormId::Zero;
+        std::atomic<uint32_t> _refs = 0;
+        uint32_t _next_free = 0;    // the free list of form_entry_table
+        std::atomic<bool> _deleted = false;
+        // remember whether a form handle was retained or not
+        // to not release it if the handle wasn't be previously retained (for ex. handle's object was not loaded)
+        bool _is_handle_retained = false;
+        // the form_observer's deletion stamp when the form was last watched, guarded by the form_table shard's lock.
+        // A queued deletion flags the entry only if it's newer
+        uint32_t _watched_at = 0;
+
+        friend class form_entry_table;
+        friend struct form_entry_pointer;
+
+    public:
+
+        form_entry() = default;
+
+        static form_ref make(FormId handle);
+        static form_ref make_expired(FormId handle);
+
+        FormId id() const { return _handle; }
+
+        bool is_deleted() const {
+            return _deleted.load(std::memory_order_acquire);
+        }
+
+        void set_deleted() {
+            _deleted.store(true, std::memory_order_release);
+        }
+
+        bool u_is_deleted() const {
+            return _deleted;
+        }
+        void u_set_deleted() {
+            _deleted = true;
+        }
+
+        uint32_t u_watched_at() const { return _watched_at; }
+        void u_set_watched_at(uint32_t stamp) { _watched_at = stamp; }
+
+        uint32_t use_count() const { return _refs.load(std::memory_order_relaxed); }
+
+        friend class boost::serialization::access;
+        BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+        template<class Archive> void save(Archive & ar, const unsigned int version) const;
+        template<class Archive> void load(Archive & ar, const unsigned int version);
+    };
+
+    // Stores all form entries in chunks which never move, so a 32-bit index addresses an entry.
+    // Freed entries are reused. Never destroyed: form_refs may outlive anything static
+    class form_entry_table {
+
+        static const uint32_t chunk_size = 4096;
+        static const uint32_t max_chunks = 4096;
+
+        std::atomic<form_entry*> _chunks[max_chunks] = {};
+        std::atomic_flag _lock = ATOMIC_FLAG_INIT;
+        uint32_t _free_head = 0;
+        uint32_t _count = 1;    // index 0 is null
+
+        static form_entry_table s_instance;
+
+        struct guard {
+            std::atomic_flag& flag;
+            explicit guard(std::atomic_flag& f) : flag(f) {
+                while (flag.test_and_set(std::memory_order_acquire)) {}
+            }
+            ~guard() { flag.clear(std::memory_order_release); }
+        };
+
+        uint32_t u_allocate();
+        void free(uint32_t index);
+
+    public:
+
+        static form_entry& at(uint32_t index) {
+            return s_instance._chunks[index / chunk_size].load(std::memory_order_acquire)[index % chunk_size];
+        }
+
+        // a new entry, with no references yet. 0 if the table is full
+        static uint32_t allocate(FormId handle, bool deleted, bool handle_was_retained);
+
+        static void add_ref(uint32_t index) {
+            at(index)._refs.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static void release(uint32_t index) {
+            if (at(index)._refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                s_instance.free(index);
+            }
+        }
+    };
+
+    inline form_entry_table form_entry_table::s_instance;
+
+    // A single word: the raw form id and the index of the form's entry in the form_entry_table.
+    // The raw id is read without touching the entry, which is what ordered containers compare the most
+    class form_ref {
+        uint64_t _word = 0;
+
+        uint32_t index() const { return static_cast<uint32_t>(_word >> 32); }
+
+        // shares the entry at the @index
+        explicit form_ref(uint32_t index)
+            : _word(index ? (uint64_t(index) << 32) | uint64_t(form_entry_table::at(index).id()) : 0)
+        {
+            if (index) {
+                form_entry_table::add_ref(index);
+            }
+        }
+
+        friend class form_entry;
+        friend struct form_entry_pointer;
+
+    public:
+
+        form_ref() = default;
+
+        form_ref(const form_ref& other) : _word(other._word) {
+            if (auto idx = index()) {
+                form_entry_table::add_ref(idx);
+            }
+        }
+
+        form_ref(form_ref&& other) BOOST_NOEXCEPT : _word(other._word) {
+            other._word = 0;
+        }
+
+        form_ref& operator = (const form_ref& other) {
+            form_ref(other).swap(*this);
+            return *this;
+        }
+
+        form_ref& operator = (form_ref&& other) BOOST_NOEXCEPT {
+            form_ref(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        ~form_ref() {
+            if (auto idx = index()) {
+                form_entry_table::release(idx);
+            }
+        }
+
+        form_ref(FormId id, form_observer& watcher);
+        form_ref(const TESForm& form, form_observer& watcher);
+
+        static form_ref make_expired(FormId formId);
+
+        // Special constructor - to load pre v3.3 data
+        enum load_old_id_t { load_old_id };
+        explicit form_ref(FormId oldId, form_observer& watcher, load_old_id_t);
+
+        form_entry* entry() const { return index() ? &form_entry_table::at(index()) : nullptr; }
+
+        bool is_not_expired() const { return index() && !form_entry_table::at(index()).is_deleted(); }
+        bool is_expired() const { return !is_not_expired(); }
+
+        FormId get() const { return is_not_expired() ? get_raw() : FormId::Zero; }
+        FormId get_raw() const { return static_cast<FormId>(static_cast<uint32_t>(_word)); }
+
+        bool operator!() const BOOST_NOEXCEPT { return is_expired(); }
+        BOOST_EXPLICIT_OPERATOR_BOOL_NOEXCEPT();
+
+        void swap(form_ref& other) {
+            static_assert(sizeof(other) == sizeof(_word),
+                "ensures that no additional fields were added");
+            std::swap(_word, other._word);
+        }
+
+        struct stable_less_comparer;
+
+        friend class boost::serialization::access;
+        BOOST_SERIALIZATION_SPLIT_MEMBER();
+
+        template<class Archive> void save(Archive & ar, const unsigned int version) const;
+        template<class Archive> void load(Archive & ar, const unsigned int version);
+    };
+
+    // Implements stable 'less than' form_ref comparison
+    // Note that the comparison is not as stable as before - due to is_expired() function which
+    // may start returning False once a form_ref gets expired.
+    // And in a result of this a map container of <form_ref, value> keys containing expired and non-expired form_ref-keys 
+    // (with equal raw form ids) may start contain equal two keys and may act weird
+    struct form_ref::stable_less_comparer {
+        using is_transparent = void;  // ordered containers look up by anything with get_raw() and is_expired()
+
+        template<class FormRef1, class FormRef2>
+        bool operator () (const FormRef1& left, const FormRef2& right) const {
+            // same as comparing (get_raw, is_expired) pairs, but the entries are read for equal raw ids only
+            const auto l = left.get_raw(), r = right.get_raw();
+            return l != r ? l < r : left.is_expired() < right.is_expired();
+        }
+    };
+}
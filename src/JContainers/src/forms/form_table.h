@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "util/spinlock.h"
+#include "forms/form_ref.h"
+
+namespace forms {
+
+    /**
+     * The form_observer's table: form_refs keyed by their raw form id (read from the form_ref itself).
+     * Split into shards, each is an open-addressing (linear probing) array guarded by a spinlock.
+     * Erasure shifts the following entries back instead of leaving tombstones. An entry which nothing
+     * but the table references is dropped when a lookup passes by it.
+     */
+    class form_table {
+
+        static const uint32_t shard_count = 64;
+        static const uint32_t initial_capacity = 16;
+        static const uint32_t max_dropped_per_update = 4;
+
+        struct shard {
+            util::spinlock lock;
+            std::vector<form_ref> slots;    // empty slot - null form_ref
+            uint32_t count = 0;
+        };
+
+        std::array<shard, shard_count> _shards;
+
+        static uint64_t hash(FormId id) {
+            return uint64_t(id) * 0x9E3779B97F4A7C15ull;
+        }
+
+        shard& shard_for(FormId id) {
+            return _shards[hash(id) >> 58];
+        }
+
+        static uint32_t home(const shard& sh, FormId id) {
+            return static_cast<uint32_t>(hash(id) >> 20) & uint32_t(sh.slots.size() - 1);
+        }
+
+        static bool is_table_only(const form_ref& ref) {
+            return ref.entry()->use_count() == 1;
+        }
+
+        // backward shift: the entries of the probe sequence after @pos move closer to their home slot
+        static void u_erase_at(shard& sh, uint32_t pos) {
+            const uint32_t mask = uint32_t(sh.slots.size() - 1);
+            uint32_t hole = pos;
+            for (uint32_t next = (pos + 1) & mask; sh.slots[next].entry(); next = (next + 1) & mask) {
+                const uint32_t next_home = home(sh, sh.slots[next].get_raw());
+                // moves unless the entry's home lies cyclically in (hole, next]
+                const bool stays = hole <= next
+                    ? (hole < next_home && next_home <= next)
+                    : (hole < next_home || next_home <= next);
+                if (!stays) {
+                    sh.slots[hole] = std::move(sh.slots[next]);
+                    hole = next;
+                }
+            }
+            sh.slots[hole] = form_ref();
+            --sh.count;
+        }
+
+        static void u_insert(shard& sh, form_ref&& ref) {
+            const uint32_t mask = uint32_t(sh.slots.size() - 1);
+            uint32_t pos = home(sh, ref.get_raw());
+            while (sh.slots[pos].entry()) {
+                pos = (pos + 1) & mask;
+            }
+            sh.slots[pos] = std::move(ref);
+            ++sh.count;
+        }
+
+        static void u_rehash(shard& sh, uint32_t capacity) {
+            std::vector<form_ref> old(capacity);
+            old.swap(sh.slots);
+            sh.count = 0;
+            for (auto& ref : old) {
+                if (ref.entry()) {
+                    u_insert(sh, std::move(ref));
+                }
+            }
+        }
+
+        // drops up to max_dropped_per_update - @dropped_count table-only entries into the @dropped
+        template<class F>
+        static void u_update(shard& sh, FormId id, F& func, form_ref* dropped, uint32_t& dropped_count) {
+            if ((sh.count + 1) * 10 > sh.slots.size() * 7) {
+                u_rehash(sh, uint32_t(sh.slots.size() * 2));
+            }
+
+            const uint32_t mask = uint32_t(sh.slots.size() - 1);
+            uint32_t pos = home(sh, id);
+            for (;;) {
+                auto& slot = sh.slots[pos];
+                if (!slot.entry() || slot.get_raw() == id) {
+                    break;
+                }
+                if (dropped_count < max_dropped_per_update && is_table_only(slot)) {
+                    dropped[dropped_count++] = std::move(slot);
+                    u_erase_at(sh, pos);    // the next entry of the sequence may shift into @pos, look at it again
+                    continue;
+                }
+                pos = (pos + 1) & mask;
+            }
+
+            auto& slot = sh.slots[pos];
+            const bool existed = slot.entry() != nullptr;
+            func(slot);
+
+            if (existed && !slot.entry()) {
+                u_erase_at(sh, pos);
+            }
+            else if (!existed && slot.entry()) {
+                ++sh.count;
+            }
+        }
+
+    public:
+
+        form_table() {
+            for (auto& sh : _shards) {
+                sh.slots.resize(initial_capacity);
+            }
+        }
+
+        /// Calls @func(form_ref& slot) under the lock of the @id's shard. The slot is empty if the table has no @id.
+        /// The slot gets erased if @func leaves it empty
+        template<class F>
+        void update(FormId id, F&& func) {
+            form_ref dropped[max_dropped_per_update];   // released out of the lock
+            uint32_t dropped_count = 0;
+
+            auto& sh = shard_for(id);
+            std::lock_guard<util::spinlock> guard{ sh.lock };
+            u_update(sh, id, func, dropped, dropped_count);
+        }
+
+        /// @update for each distinct id of the @ids, all ids of a shard are updated under a single lock.
+        /// Sorts and deduplicates the @ids. Unlike @update, doesn't drop unused entries on the way
+        template<class F>
+        void update_batch(std::vector<FormId>& ids, F&& func) {
+            std::sort(ids.begin(), ids.end(), [](FormId l, FormId r) {
+                const uint64_t lh = hash(l) >> 58, rh = hash(r) >> 58;
+                return lh != rh ? lh < rh : l < r;
+            });
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            uint32_t no_drops = max_dropped_per_update;
+            for (size_t i = 0; i < ids.size();) {
+                auto& sh = shard_for(ids[i]);
+                std::lock_guard<util::spinlock> guard{ sh.lock };
+                for (; i < ids.size() && &shard_for(ids[i]) == &sh; ++i) {
+                    u_update(sh, ids[i], func, nullptr, no_drops);
+                }
+            }
+        }
+
+        // Not threadsafe part of API:
+
+        uint32_t u_count() const {
+            uint32_t count = 0;
+            for (auto& sh : _shards) {
+                count += sh.count;
+            }
+            return count;
+        }
+
+        template<class F>
+        void u_for_each(F&& func) const {
+            for (auto& sh : _shards) {
+                for (auto& ref : sh.slots) {
+                    if (ref.entry()) {
+                        func(ref);
+                    }
+                }
+            }
+        }
+
+        template<class Predicate>
+        void u_remove_if(Predicate&& pred) {
+            for (auto& sh : _shards) {
+                for (auto& ref : sh.slots) {
+                    if (ref.entry() && pred(ref)) {
+                        ref = form_ref();
+                    }
+                }
+                u_rehash(sh, uint32_t(sh.slots.size()));
+            }
+        }
+
+        void u_clear() {
+            for (auto& sh : _shards) {
+                std::vector<form_ref>(initial_capacity).swap(sh.slots);
+                sh.count = 0;
+            }
+        }
+    };
+}
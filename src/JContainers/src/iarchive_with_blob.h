@@ -25,14 +25,6 @@ namespace hack {
             return std::get<T&>(_blob);
         }
 
-        template<> T0& get<T0>() {
-            return std::get<0>(_blob);
-        }
-
-        template<> T1& get<T1>() {
-            return std::get<1>(_blob);
-        }
-
         iarchive_with_blob_templ() = delete;
 
         template<class ...Types>
@@ -45,7 +37,7 @@ namespace hack {
         static T& from_base_get(iarchive_with_blob_base& base) {
             auto blob = dynamic_cast<iarchive_with_blob_templ*>(&base);
             assert(blob);
-            return blob->get<T>();
+            return blob->template get<T>();
         }
     };
 
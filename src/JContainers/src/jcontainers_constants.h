@@ -18,6 +18,15 @@ namespace collections {
 
 #   define JC_DATA_FILES            "JCData/"
 
+    // Idle Lua contexts each domain keeps ready for JValue.evalLua*, JContainers.setLuaContextPoolLimits changes it
+#   define JC_LUA_PREWARMED_CONTEXTS    2
+    // Lua contexts a domain keeps, a thread waits that long for a free one before creating one more
+#   define JC_LUA_MAX_CONTEXTS          16
+#   define JC_LUA_CONTEXT_WAIT_MS       20
+
+    // The game's form deletion callback only queues the forms, the background thread flags them in batches
+#   define JC_BATCH_FORM_DELETION       1
+
 #ifdef JC_SKSE_VR
 
 #   define JC_PLUGIN_NAME           "JContainersVR"
@@ -3,6 +3,10 @@
 #include <vector>
 #include <string>
 
-#include "common/IPrefix.h"
+#ifdef JC_CORE
+#   include "core_prefix.h"
+#else
+#   include "common/IPrefix.h"
+#endif
 
 #include "typedefs.h"
\ No newline at end of file
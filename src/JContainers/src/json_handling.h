@@ -400,6 +400,19 @@ namespace collections {
                 json_ref object;
 
                 void operator () (array& cnt) {
+                    if (auto ints = cnt.u_ints()) {
+                        for (auto value : *ints) {
+                            json_array_append_new(object, json_integer(value));
+                        }
+                        return;
+                    }
+                    if (auto floats = cnt.u_floats()) {
+                        for (auto value : *floats) {
+                            json_array_append_new(object, json_real(value));
+                        }
+                        return;
+                    }
+
                     size_t index = 0;
                     for (auto& itm : cnt.u_container()) {
                         self->fill_key_info(itm, cnt, index++);
@@ -5,7 +5,7 @@
 // It's assumed that meta class instance will reside in static memory only!
 template<class T, class Tag = void> class meta
 {
-    private: meta * const next;    // temporary publicly accessible
+    private: meta * next;    // temporary publicly accessible
     public: T info;
 
     public: class iterator {
@@ -50,7 +50,7 @@ template<class T, class Tag = void> class meta
         if (!l.first)
             l.first = this;
         if (l.last)
-            const_cast<meta *>(l.last->next) = this;
+            l.last->next = this;
         l.last = this;
         ++l.count;
     }
@@ -2,19 +2,28 @@
 
 #include <atomic>
 #include <deque>
-#include <boost\serialization\version.hpp>
-#include <boost\asio\io_service.hpp>
-#include <boost\asio\deadline_timer.hpp>
-#include "common\IThread.h"
-#include "util\util.h"
-#include "util\singleton.h"
+#include <boost/serialization/version.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include "util/util.h"
+#include "util/singleton.h"
+
+#ifdef _WIN32
+#   include "common/IThread.h"
+#else
+#   include <thread>
+#endif
 
 namespace collections {
 
 
     namespace detail {
 
-#   define WINE_SUPPORT 1
+#   ifdef _WIN32
+#       define WINE_SUPPORT 1
+#   else
+#       define WINE_SUPPORT 0
+#   endif
 
         struct background_worker {
             boost::asio::io_service _io;
@@ -39,6 +48,7 @@ namespace collections {
                 _thread.Stop();
                 WaitForSingleObject(_thread.GetHandle(), INFINITE);
 #   else
+                _io.stop(); // the _work would keep the thread running
                 if (_thread.joinable()) {
                     _thread.join();
                 }
@@ -2,6 +2,7 @@
 
 #include <mutex>
 #include <atomic>
+#include <functional>
 #include <assert.h>
 #include <boost/optional/optional.hpp>
 #include "boost/noncopyable.hpp"
@@ -21,7 +22,7 @@ namespace collections {
     class object_base;
     class object_context;
 
-    enum CollectionType {
+    enum CollectionType : uint8_t {
         None = 0,
         Array,
         Map,
@@ -51,28 +52,32 @@ namespace collections {
     public:
         std::atomic<Handle> _id                 = Handle::Null;
 
-        std::atomic_int32_t _refCount           = 0;
+        std::atomic_int32_t _refCount           = 0;    // other objects and the stack (native code, Lua) own it
         std::atomic_int32_t _tes_refCount       = 0;
-        std::atomic_int32_t _stack_refCount     = 0;
         std::atomic_int32_t _aqueue_refCount    = 0;
         time_point _aqueue_push_time            = 0;
 
         CollectionType                          _type = CollectionType::None;
-        util::istring                           _tag;
+        mutable util::rw_spinlock               _mutex;   // exclusive for writes, shared for the reads via object_read_lock
+        bool                                    _tagged = false;  // the tag itself lives in a side table, few objects have one
     private:
         object_context *_context                = nullptr;
 
         void release_counter(std::atomic_int32_t& counter);
-        bool is_completely_initialized() const { return _context != nullptr; }
         void try_prolong_lifetime();
 
     public:
+        // false while the object is being constructed or loaded and has no context yet
+        bool is_completely_initialized() const { return _context != nullptr; }
 
-        virtual ~object_base() {}
+        virtual ~object_base() {
+            if (_tagged) {
+                u_set_tag(nullptr);
+            }
+        }
 
     public:
-        using lock = std::lock_guard<spinlock>;
-        mutable spinlock _mutex;
+        using lock = std::lock_guard<util::rw_spinlock>;
 
         explicit object_base(CollectionType type)
             : _type(type)
@@ -92,7 +97,7 @@ namespace collections {
             return _uid() != Handle::Null;
         }
 
-        spinlock& mutex() const { return _mutex; }
+        util::rw_spinlock& mutex() const { return _mutex; }
 
         template<class T> T* as() {
             return const_cast<T*>(const_cast<const object_base*>(this)->as<T>());
@@ -102,10 +107,6 @@ namespace collections {
             return (this && T::TypeId == _type) ? static_cast<const T*>(this) : nullptr;
         }
 
-        template<> const object_base* as<object_base>() const {
-            return this;
-        }
-
         template<class T> T& as_link() {
             return const_cast<T&>(const_cast<const object_base*>(this)->as_link<T>());
         }
@@ -124,14 +125,13 @@ namespace collections {
         object_base * tes_retain();
 
         int32_t refCount() const {
-            return _refCount + _tes_refCount + _stack_refCount + _aqueue_refCount;
+            return _refCount + _tes_refCount + _aqueue_refCount;
         }
         bool noOwners() const {
             return
                 _refCount.load() <= 0 &&
                 _tes_refCount.load() <= 0 &&
-                _aqueue_refCount.load() <= 0 &&
-                _stack_refCount.load() <= 0;
+                _aqueue_refCount.load() <= 0;
         }
 
         bool u_is_user_retains() const {
@@ -147,7 +147,7 @@ namespace collections {
 
         void release();
         void tes_release();
-        void stack_retain() { ++_stack_refCount; }
+        void stack_retain() { ++_refCount; }
         void stack_release();
 
         // releases and then deletes object if no owners
@@ -176,10 +176,7 @@ namespace collections {
         // release calls and resulting deadlock
         virtual void u_nullifyObjects() = 0;
 
-        SInt32 s_count() const {
-            lock g(_mutex);
-            return u_count();
-        }
+        SInt32 s_count() const;
 
         void s_clear() {
             lock g(_mutex);
@@ -189,23 +186,26 @@ namespace collections {
         void set_tag (const char* tag)
         {
             lock g (_mutex);
-            if (tag) _tag = tag;
-            else _tag.clear ();
+            u_set_tag (tag);
         }
 
-        bool has_equal_tag (char const* tag) const
-        {
-            if (tag)
-            {
-                lock g (_mutex);
-                return _tag == tag;
-            }
-            return false;
-        }
+        bool has_equal_tag (char const* tag) const;
+
+        // an empty @tag (or null) removes the tag
+        void u_set_tag(const char* tag);
+        util::istring u_tag() const;
 
         virtual void u_visit_referenced_objects(const std::function<void(object_base&)>& visitor) {}
     };
 
+    template<> inline const object_base* object_base::as<object_base>() const {
+        return this;
+    }
+
+    // millions of tiny containers are possible: two pointers (the vtable and the context) plus 24 bytes of
+    // the handle, counters, type, lock and flags. Was 88 bytes on x64 and 64 on x86
+    static_assert(sizeof(object_base) <= 2 * sizeof(void*) + 24, "object_base header grew");
+
     inline void object_base_stack_ref_policy::retain(object_base * p) {
         p->stack_retain();
     }
@@ -236,4 +236,49 @@ namespace collections {
         template<class T, class P>
         explicit object_lock(const boost::intrusive_ptr_jc<T, P>& ref) : _lock(static_cast<const object_base&>(*ref)._mutex) {}
     };
+
+    /// Locks two distinct objects in the order of their addresses, as a batched transaction locks its containers,
+    /// so the calls locking the same objects never deadlock, whatever order their arguments come in
+    class object_lock_pair : public boost::noncopyable {
+        object_lock _first;
+        object_lock _second;
+    public:
+        object_lock_pair(const object_base& a, const object_base& b)
+            : _first(std::less<const object_base*>()(&a, &b) ? a : b)
+            , _second(std::less<const object_base*>()(&a, &b) ? b : a)
+        {
+            jc_assert(&a != &b);
+        }
+    };
+
+    /// Lets the readers of an object in together. The reads must not change the object: no writes through
+    /// the item pointers, and arrays are read with u_read_at, which doesn't unpack their packed numbers
+    class object_read_lock : public boost::noncopyable {
+        util::rw_spinlock& _lock;
+    public:
+        explicit object_read_lock(const object_base *obj) : object_read_lock(*obj) {}
+        explicit object_read_lock(const object_base &obj) : _lock(obj._mutex) {
+            _lock.lock_shared();
+        }
+
+        template<class T, class P>
+        explicit object_read_lock(const boost::intrusive_ptr_jc<T, P>& ref) : object_read_lock(static_cast<const object_base&>(*ref)) {}
+
+        ~object_read_lock() {
+            _lock.unlock_shared();
+        }
+    };
+
+    inline SInt32 object_base::s_count() const {
+        object_read_lock g(this);
+        return u_count();
+    }
+
+    inline bool object_base::has_equal_tag(char const* tag) const {
+        if (tag) {
+            object_read_lock g(this);
+            return u_tag() == tag;
+        }
+        return false;
+    }
 }
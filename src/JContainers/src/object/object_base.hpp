@@ -79,9 +79,8 @@ namespace collections
     }
 
     void object_base::_delete_self() {
-        // it's still possible that something will attepmt to access this object now?
-        context().registry->removeObject(*this);
-        delete this;
+        // a thread may still access the object through a borrowed pointer, the deletion waits for it
+        context().retire(*this);
     }
 
     object_base* object_base::tes_retain() {
@@ -101,8 +100,8 @@ namespace collections
     }
 
     void object_base::stack_release() {
-        if (_stack_refCount > 0) {
-            --_stack_refCount;
+        if (_refCount > 0) {
+            --_refCount;
             if (noOwners()) {
                 // the object no more referenced by Lua or stack, no owners - I may even delete it immediately
                 // (immediately if the object is not exposed to Skyrim, i.e. has no public ID)
@@ -143,6 +142,43 @@ namespace collections
         return this;
     }
 
+    namespace {
+        // the tags of all the objects, of any context. Lives in its own table as few objects have a tag
+        struct tag_table {
+            util::spinlock lock;
+            std::unordered_map<const object_base*, util::istring> tags;
+        };
+
+        // never destroyed: the objects of the static contexts may be deleted after it
+        tag_table& tags() {
+            static tag_table* t = new tag_table();
+            return *t;
+        }
+    }
+
+    void object_base::u_set_tag(const char* tag) {
+        auto& t = tags();
+        util::spinlock::guard g(t.lock);
+        if (tag && *tag) {
+            t.tags[this] = tag;
+            _tagged = true;
+        }
+        else if (_tagged) {
+            t.tags.erase(this);
+            _tagged = false;
+        }
+    }
+
+    util::istring object_base::u_tag() const {
+        if (!_tagged) {
+            return util::istring();
+        }
+        auto& t = tags();
+        util::spinlock::guard g(t.lock);
+        auto itr = t.tags.find(this);
+        return itr != t.tags.end() ? itr->second : util::istring();
+    }
+
     object_base* object_base::zero_lifetime() {
         context().aqueue->not_prolong_lifetime(*this);
         return this;
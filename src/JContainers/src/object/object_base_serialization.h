@@ -1,8 +1,8 @@
 #pragma once
 
-#include "boost\serialization\split_free.hpp"
-#include "boost\serialization\version.hpp"
-#include "boost\serialization\optional.hpp"
+#include "boost/serialization/split_free.hpp"
+#include "boost/serialization/version.hpp"
+#include "boost/serialization/optional.hpp"
 
 #include "util/atomic_serialization.h"
 #include "object_base.h"
@@ -15,8 +15,6 @@ namespace boost { namespace serialization {
     void save(Archive & ar, const cl::object_base & t, unsigned int version) {
         //jc_assert(version == 1);
 
-        // Lua retains an objects with _stack_refCount counter. Asertion disabled 
-        //jc_assert(t._stack_refCount.load(std::memory_order_relaxed) == 0);
         jc_assert(t.noOwners() == false);
 
         switch (version) {
@@ -34,7 +32,8 @@ namespace boost { namespace serialization {
 
         save_atomic(ar, t._tes_refCount);
         save_atomic(ar, t._id);
-        ar << *reinterpret_cast<std::string const*> (&t._tag); //force Boost detection
+        auto tag = t.u_tag();
+        ar << *reinterpret_cast<std::string const*> (&tag); //force Boost detection
     }
 
     template<class Archive>
@@ -57,7 +56,11 @@ namespace boost { namespace serialization {
         case 2:
         case 1:
             load_atomic (ar, t._id);
-            ar >> *reinterpret_cast<std::string*> (&t._tag); //force Boost detection
+            {
+                util::istring tag;
+                ar >> *reinterpret_cast<std::string*> (&tag); //force Boost detection
+                t.u_set_tag(tag.c_str());
+            }
             break;
         case 0:
             ar >> t._type;
@@ -69,7 +72,7 @@ namespace boost { namespace serialization {
         }
 
         // "trying detect objects with no owners" - not possible to do this assertion anymore:
-        // Lua retains an objects with _stack_refCount counter. Asertion disabled 
+        // Lua retains an objects with the stack references. Asertion disabled 
         //jc_assert(version == 0 || t.noOwners() == false);
     }
 
@@ -5,6 +5,7 @@
 #include <deque>
 #include <boost/serialization/split_member.hpp>
 
+#include "util/epoch.h"
 #include "object_base.h"
 
 namespace boost {
@@ -32,7 +33,9 @@ namespace collections {
         no_header = 3, // no JSON header in the beginning of a stream
         pre_gc = 4, // next version implements GC
         pre_dyn_form_watcher = 5, // next version implements dynamic-form-watcher
-        current = 6,
+        pre_interned_keys = 6, // next version writes each distinct JMap key once
+        pre_packed_arrays = 7, // next version writes JIntArray/JFltArray numbers packed
+        current = 8,
     };
 
     /*
@@ -77,10 +80,29 @@ namespace collections {
         size_t object_count() const;
         object_base * getObject(Handle hdl);
         object_stack_ref getObjectRef(Handle hdl);
+        /// The @obj if it's still registered (not being deleted)
+        object_stack_ref getObjectRef(object_base* obj);
         object_base * u_getObject(Handle hdl);
 
         // exposed for testing purposes only
         size_t collect_garbage();
+
+        /// Unregisters the @obj, clears it and deletes it once no thread pinned in util::epoch can reach it
+        void retire(object_base& obj);
+        /// Deletes the retired objects no pinned thread can reach
+        void reclaim();
+        size_t retired_count() const;
+
+    private:
+        enum { retired_batch = 64 };    // the retired objects reclaimed at once
+
+        mutable spinlock _retired_mutex;
+        std::vector<std::pair<util::epoch::value, object_base*>> _retired;
+        // the size @_retired has to reach before retire() reclaims again: twice the objects a long pin left behind
+        size_t _reclaim_threshold = retired_batch;
+
+        void u_delete_retired();
+
     public:
 
         // stops object_context's activity, until destroyed and then restarts it 
@@ -116,5 +138,8 @@ namespace collections {
 
     };
 
+    // runs the @task on the thread which drives the autorelease queue
+    void post_background_task(std::function<void()> task);
+
 }
 
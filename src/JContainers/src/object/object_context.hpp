@@ -1,4 +1,5 @@
 #include "util/util.h"
+#include "util/profiling.h"
 
 namespace collections
 {
@@ -59,9 +60,68 @@ namespace collections
 
             registry->u_clear();
             aqueue->u_clear();
+            u_delete_retired();
         }
     }
 
+    void object_context::retire(object_base& obj) {
+        registry->removeObject(obj);    // no new reader finds the object
+        {
+            // releases the referenced objects now, as the deletion did: the GC and AQueue expect that
+            object_lock g(obj);
+            obj.u_clear();
+        }
+
+        bool full = false;
+        {
+            auto tag = util::epoch::retire_tag();
+            spinlock::guard g(_retired_mutex);
+            _retired.emplace_back(tag, &obj);
+            full = _retired.size() >= _reclaim_threshold;
+        }
+
+        if (full) {
+            reclaim();
+        }
+    }
+
+    void object_context::reclaim() {
+        std::vector<object_base*> unreachable;
+        {
+            spinlock::guard g(_retired_mutex);
+            if (_retired.empty()) {
+                return;
+            }
+
+            auto bound = util::epoch::reclaim_bound();
+            auto reachable_end = std::partition(_retired.begin(), _retired.end(),
+                [bound](const std::pair<util::epoch::value, object_base*>& p) { return p.first >= bound; });
+            for (auto itr = reachable_end; itr != _retired.end(); ++itr) {
+                unreachable.push_back(itr->second);
+            }
+            _retired.erase(reachable_end, _retired.end());
+            _reclaim_threshold = (std::max)(size_t(retired_batch), _retired.size() * 2);
+        }
+
+        for (auto obj : unreachable) {
+            delete obj;
+        }
+    }
+
+    size_t object_context::retired_count() const {
+        spinlock::guard g(_retired_mutex);
+        return _retired.size();
+    }
+
+    // the objects are cleared already, no need to nullify them
+    void object_context::u_delete_retired() {
+        for (auto& p : _retired) {
+            delete p.second;
+        }
+        _retired.clear();
+        _reclaim_threshold = retired_batch;
+    }
+
     std::vector<object_stack_ref> object_context::filter_objects(std::function<bool(object_base& obj)> predicate) const {
         return registry->filter_objects(predicate);
     }
@@ -74,6 +134,10 @@ namespace collections
         return registry->getObjectRef(hdl);
     }
 
+    object_stack_ref object_context::getObjectRef(object_base* obj) {
+        return registry->getObjectRef(obj);
+    }
+
     object_base * object_context::u_getObject(Handle hdl) {
         return registry->u_getObject(hdl);
     }
@@ -89,6 +153,7 @@ namespace collections
     size_t object_context::collect_garbage() {
         activity_stopper s{ *this };
         auto res = garbage_collector::u_collect(*registry, *aqueue);
+        reclaim();
         return res.garbage_total;
     }
 
@@ -96,17 +161,32 @@ namespace collections
 
     template<>
     void object_context::load(boost::archive::binary_iarchive & ar, unsigned int version) {
-        ar >> *registry >> *aqueue;
+        {
+            util::profiling::phase_scope p{ "registry" };
+            ar >> *registry;
+        }
+        util::profiling::phase_scope p{ "aqueue" };
+        ar >> *aqueue;
     }
 
     template<>
     void object_context::save(boost::archive::binary_oarchive & ar, unsigned int version) const {
-        ar << *registry << *aqueue;
+        {
+            util::profiling::phase_scope p{ "registry" };
+            ar << *registry;
+        }
+        util::profiling::phase_scope p{ "aqueue" };
+        ar << *aqueue;
     }
 
     template<>
     void object_context::load_data_in_old_way(boost::archive::binary_iarchive& ar) {
-        ar >> *registry >> *aqueue;
+        {
+            util::profiling::phase_scope p{ "registry" };
+            ar >> *registry;
+        }
+        util::profiling::phase_scope p{ "aqueue" };
+        ar >> *aqueue;
     }
 
     void object_context::u_print_stats() const {
@@ -130,6 +210,7 @@ namespace collections
     {
         util::do_with_timing("Garbage collection", [&]() {
             auto res = garbage_collector::u_collect(*registry, *aqueue);
+            reclaim();
             JC_log("%u garbage objects collected. %u objects are parts of cyclic graphs", res.garbage_total, res.part_of_graphs);
         });
     }
@@ -146,5 +227,8 @@ namespace collections
         _dependent_contexts.erase(std::remove(_dependent_contexts.begin(), _dependent_contexts.end(), &ctx), _dependent_contexts.end());
     }
 
+    void post_background_task(std::function<void()> task) {
+        detail::g_background_worker.get()._io.post(std::move(task));
+    }
 
 }
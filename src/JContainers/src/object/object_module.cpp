@@ -6,11 +6,10 @@
 #include <vector>
 #include <atomic>
 #include <memory>
+#include <unordered_map>
 
 #include <jansson.h>
 
-#define _SILENCE_STDEXT_HASH_DEPRECATION_WARNINGS
-
 #include <boost/serialization/serialization.hpp>
 #include <boost/serialization/export.hpp>
 
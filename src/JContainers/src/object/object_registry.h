@@ -1,5 +1,5 @@
-#include <hash_set>
-#include <hash_map>
+#include <unordered_set>
+#include <unordered_map>
 
 namespace collections
 {
@@ -86,6 +86,12 @@ namespace collections
             return objects;
         }
 
+        // the caller pins util::epoch: the objects stay in memory until it unpins, even the ones retired meanwhile
+        std::vector<object_base*> pinned_objects() const {
+            read_lock r(_mutex);
+            return std::vector<object_base*>(_all_objects.begin(), _all_objects.end());
+        }
+
         object_stack_ref getObjectRef(Handle hdl) const {
             // had to copy&paste getObject function as we really must own an object BEFORE read lock will be released
             if (hdl == Handle::Null) {
@@ -95,6 +101,12 @@ namespace collections
             return u_getObject(hdl);
         }
 
+        // the @obj if it's still registered (not being deleted)
+        object_stack_ref getObjectRef(object_base* obj) const {
+            read_lock g(_mutex);
+            return _all_objects.count(obj) ? obj : nullptr;
+        }
+
         object_base *u_getObject(Handle hdl) const {
             if (hdl == Handle::Null) {
                 return nullptr;
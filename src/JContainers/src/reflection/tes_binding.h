@@ -2,6 +2,8 @@
 
 #include "skse64/PapyrusNativeFunctions.h"
 #include "skse/string.h"
+#include "util/call_stats.h"
+#include "util/epoch.h"
 #include "reflection/reflection.h"
 
 class BGSListForm;
@@ -134,6 +136,24 @@ namespace reflection { namespace binding {
     template<class T>
     using convert_to_tes_type = typename get_converter<T>::tes_type;
 
+    // A borrowing function gets its raw pointer arguments through the converter's @borrow2J, if it has one:
+    // no reference is taken, the epoch pinned for the call keeps the objects alive
+    template<class T, bool Borrow, class = void>
+    struct arg_converter : get_converter<T> {};
+
+    template<class T>
+    struct arg_converter<T, true, std::enable_if_t<std::is_pointer<remove_cref<T>>::value, decltype((void)&get_converter<T>::borrow2J)>> {
+        template<class TesType, class State>
+        static auto convert2J(const TesType& val, State& state) {
+            return get_converter<T>::borrow2J(val, state);
+        }
+    };
+
+    struct no_pin { no_pin() {} };
+
+    template<bool Borrow>
+    using call_pin = typename std::conditional<Borrow, util::epoch::guard, no_pin>::type;
+
     // Template monster, proxy class that:
     // - adapts my internal types to native Papyrus types and vica versa
     // - generates native Papyrus function
@@ -165,11 +185,15 @@ namespace reflection { namespace binding {
                 return func;
             }
 
+            // the call_stats slot, assigned once the function is bound, before Papyrus can call it
+            static inline uint32_t stats_slot = 0;
+
             struct non_void_ret {
                 static convert_to_tes_type<R> tes_func(
                     StaticFunctionTag* tag,
                     convert_to_tes_type<Params> ... params)
                 {
+                    util::call_stats::scope stats{ stats_slot };
                     return GetConv<R>::convert2Tes(
                         func(
                             get_converter<Params>::convert2J(params, tag) ...
@@ -183,6 +207,7 @@ namespace reflection { namespace binding {
                     StaticFunctionTag* tag,
                     convert_to_tes_type<Params> ... params)
                 {
+                    util::call_stats::scope stats{ stats_slot };
                     func(get_converter<Params>::convert2J(params, tag) ...);
                 }
             };
@@ -193,6 +218,9 @@ namespace reflection { namespace binding {
                 non_void_ret>::type;
 
             static void bind(const bind_args& args) {
+                if (!stats_slot) {
+                    stats_slot = util::call_stats::register_function(args.className.c_str(), args.functionName.c_str());
+                }
                 args.registry.RegisterFunction
                 (
                     new typename native_function_selector<sizeof...(Params)>::template function<
@@ -225,7 +253,7 @@ namespace reflection { namespace binding {
         static const bool is_stateless = false;
 
         // subtype @magick to workaround some msvc2013 bug
-        template< R(*func)(State&, Params ...) >
+        template< R(*func)(State&, Params ...), bool Borrow = false >
         struct magick {
 
             using base = state_proxy;
@@ -234,15 +262,20 @@ namespace reflection { namespace binding {
                 return func;
             }
 
+            // the call_stats slot, assigned once the function is bound, before Papyrus can call it
+            static inline uint32_t stats_slot = 0;
+
             struct non_void_ret {
                 static convert_to_tes_type<R> tes_func(
                     State& state,
                     convert_to_tes_type<Params> ... params)
                 {
+                    util::call_stats::scope stats{ stats_slot };
+                    call_pin<Borrow> pin;
                     return GetConv<R>::convert2Tes(
                         func(
                             state,
-                            get_converter<Params>::convert2J(params, state) ...
+                            arg_converter<Params, Borrow>::convert2J(params, state) ...
                         )
                     );
                 }
@@ -253,7 +286,9 @@ namespace reflection { namespace binding {
                     State& state,
                     convert_to_tes_type<Params> ... params)
                 {
-                    func(state, get_converter<Params>::convert2J(params, state) ...);
+                    util::call_stats::scope stats{ stats_slot };
+                    call_pin<Borrow> pin;
+                    func(state, arg_converter<Params, Borrow>::convert2J(params, state) ...);
                 }
             };
 
@@ -263,6 +298,9 @@ namespace reflection { namespace binding {
                 non_void_ret>::type;
 
             static void bind(const bind_args& args) {
+                if (!stats_slot) {
+                    stats_slot = util::call_stats::register_function(args.className.c_str(), args.functionName.c_str());
+                }
                 args.registry.RegisterFunction
                 (
                     new typename state_native_function_selector<sizeof...(Params)>::template function<
@@ -340,6 +378,17 @@ namespace reflection { namespace binding {
         _funcname, _args, _comment \
     };
 
+// For the functions which only read their object arguments and neither keep nor return them: the arguments
+// are borrowed for the call instead of being referenced
+#define REGISTERF_BORROWED(func, _funcname, _args, _comment)\
+    ::reflection::binding::function_registree CONCAT(_func_registree_, __LINE__){ \
+        metaInfo, \
+        ::reflection::binding::state_proxy<decltype(::reflection::binding::msvc_identity(&func))>::magick<&func, true>(), \
+        _funcname, _args, _comment \
+    };
+
+#define REGISTERF2_BORROWED(func, args, comment)     REGISTERF_BORROWED(func, #func, args, comment)
+
     struct papyrus_textblock_setter {
         explicit papyrus_textblock_setter(class_info& info, const papyrus_text_block& text) {
             info.add_text_block(text);
@@ -1,5 +1,16 @@
 #include "skse/skse.h"
 
+#ifdef JC_CORE
+
+/// The game layer stub of the core build: there is no game to forward to, only the fake and silent APIs are here
+class TESForm
+{
+public:
+    std::uint32_t formID = 0;
+};
+
+#else
+
 #include "skse64/GameData.h"
 #include "skse64/GameForms.h"
 #include "skse64/GameData.h"
@@ -11,6 +22,8 @@
 #include "SkyrimVRESLAPI.h"
 #endif
 
+#endif
+
 #include "util/stl_ext.h"
 #include "forms/form_handling.h"
 
@@ -18,7 +31,9 @@
 
 #include <algorithm>
 
+#ifndef JC_CORE
 extern SKSESerializationInterface* g_serialization;
+#endif
 
 namespace skse
 {
@@ -45,7 +60,7 @@ struct skse_api
     virtual bool try_retain_handle (FormId handle) = 0;
     virtual void release_handle (FormId handle) = 0;
 
-    virtual void console_print (const char * fmt, const va_list& args) = 0;
+    virtual void console_print (const char * fmt, va_list args) = 0;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -79,7 +94,7 @@ struct fake_api : public skse_api
 
     TESForm* lookup_form (FormId) override
     {
-        static char blob[sizeof TESForm] = { '\0' };
+        static char blob[sizeof (TESForm)] = { '\0' };
         return reinterpret_cast<TESForm*> (&blob);
     }
 
@@ -87,7 +102,7 @@ struct fake_api : public skse_api
 
     void release_handle (FormId) override {}
 
-    void console_print (const char*, const va_list&) override {}
+    void console_print (const char*, va_list) override {}
 
 };
 
@@ -116,11 +131,13 @@ struct silent_api : public skse_api
     TESForm* lookup_form (FormId) override { return nullptr; }
     bool try_retain_handle (FormId) override { return true; }
     void release_handle (FormId) override {}
-    void console_print (const char*, const va_list&) override {}
+    void console_print (const char*, va_list) override {}
 };
 
 //--------------------------------------------------------------------------------------------------
 
+#ifndef JC_CORE
+
 /// Actual wrapper around thin calls to SKSE
 struct real_api : public skse_api
 {
@@ -231,17 +248,21 @@ struct real_api : public skse_api
             policy->Release (handle);
     }
 
-    void console_print (const char * fmt, const va_list& args) override
+    void console_print (const char * fmt, va_list args) override
     {
         if (ConsoleManager* mgr = *g_console)
             CALL_MEMBER_FN (mgr, VPrint) (fmt, args);
     }
 };
 
+#endif
+
 //--------------------------------------------------------------------------------------------------
 
 fake_api g_fake_api;
+#ifndef JC_CORE
 real_api g_real_api;
+#endif
 silent_api g_silent_api;
 skse_api* g_current_api = &g_fake_api;
 
@@ -251,7 +272,11 @@ skse_api* g_current_api = &g_fake_api;
 
 void set_real_api ()
 {
+#ifdef JC_CORE
+    g_current_api = &g_silent_api;  // no game in the core build
+#else
     g_current_api = &g_real_api;
+#endif
 }
 
 void set_fake_api ()
@@ -289,7 +314,7 @@ std::optional<std::string_view> loaded_light_mod_name (std::uint16_t idx)
     return g_current_api->loaded_light_mod_name (idx);
 }
 
-void console_print (const char* fmt, const va_list& args)
+void console_print (const char* fmt, va_list args)
 {
     g_current_api->console_print (fmt, args);
 }
@@ -302,6 +327,11 @@ void console_print (const char* fmt, ...)
     va_end (args);
 }
 
+FormId form_id (const TESForm& form)
+{
+    return util::to_enum<FormId> (form.formID);
+}
+
 bool try_retain_handle (FormId handle)
 {
     return g_current_api->try_retain_handle (handle);
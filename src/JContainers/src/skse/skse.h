@@ -75,7 +75,15 @@ void console_print (const char * fmt, ...);
  * If there is a console manager will call its `VPrint` function (ignored on silent/test API).
  */
 
-void console_print (const char * fmt, const va_list& args);
+void console_print (const char * fmt, va_list args);
+
+/**
+ * Reads `TESForm::formID`. Keeps the game's form layout out of the collection and form headers.
+ */
+
+forms::FormId form_id (const TESForm& form);
+
+//--------------------------------------------------------------------------------------------------
 
 /**
  * Binds the skse namespace calls to the real SKSE functions - normal mode for JC.
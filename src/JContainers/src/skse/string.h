@@ -1,6 +1,52 @@
 #pragma once
 
 #include <string>
+
+#ifdef JC_CORE
+
+#include <boost/optional.hpp>
+
+namespace skse {
+
+    /// No game string cache in the core build: the reference owns a copy of the string
+    class string_ref {
+        boost::optional<std::string> data;
+
+    public:
+
+        string_ref() { }
+
+        string_ref(const char * buf) { *this = buf; }
+
+        template<class Tr, class Alloc>
+        string_ref(const std::basic_string<char, Tr, Alloc>& string) : data(string.c_str()) { }
+
+        string_ref& operator = (const char* ref) {
+            if (ref) {
+                data = std::string(ref);
+            }
+            else {
+                data = boost::none;
+            }
+            return *this;
+        }
+
+        template<class Tr, class Alloc>
+        string_ref& operator = (const std::basic_string<char, Tr, Alloc>& string) {
+            data = std::string(string.c_str());
+            return *this;
+        }
+
+        bool operator==(const string_ref& lhs) const { return data == lhs.data; }
+
+        const char* c_str() const {
+            return data ? data->c_str() : nullptr;
+        }
+    };
+}
+
+#else
+
 #include "skse64_common/Utilities.h"
 
 namespace skse {
@@ -87,3 +133,5 @@ namespace skse {
         }
     };
 }
+
+#endif
@@ -1,5 +1,6 @@
 #include <boost/iostreams/stream.hpp>
 #include <ShlObj.h>
+#include <fstream>
 
 #include "skse64/PluginAPI.h"
 #include "skse64_common/skse_version.h"
@@ -14,11 +15,13 @@
 #include "skse/skse.h"
 #include "skse64/PapyrusVM.h"
 #include "util/util.h"
+#include "util/profiling.h"
 #include "jc_interface.h"
 #include "reflection/reflection.h"
 #include "jcontainers_constants.h"
 
 #include "collections/context.h"
+#include "collections/lua_module.h"
 #include "forms/form_observer.h"
 
 #include "domains/domain_master.h"
@@ -40,6 +43,21 @@ namespace {
 
     static PluginHandle					g_pluginHandle = kPluginHandle_Invalid;
 
+    /// Dumps the profiling report of the last save or load next to the plugin log
+    void write_profiling_report(const char *operation) {
+        char path[MAX_PATH];
+        if (!SUCCEEDED(SHGetFolderPath(NULL, CSIDL_MYDOCUMENTS, NULL, SHGFP_TYPE_CURRENT, path))) {
+            return;
+        }
+
+        strcat_s(path, sizeof(path), JC_SKSE_LOGS JC_PLUGIN_NAME "_");
+        strcat_s(path, sizeof(path), operation);
+        strcat_s(path, sizeof(path), ".json");
+
+        std::ofstream file(path);
+        file << util::profiling::report::last_as_json(operation);
+    }
+
     void revert(SKSESerializationInterface * intfc) {
         util::do_with_timing("Revert", []() {
             skse::set_silent_api();
@@ -70,6 +88,7 @@ namespace {
                 io::stream<skse_data_sink> stream(skse_data_sink{ intfc });
                 domain_master::master::instance().write_to_stream(stream);
                 //_DMESSAGE("%lu bytes saved", stream.tellp());
+                write_profiling_report("save");
             }
             else {
                 JC_log("Unable open JC record");
@@ -114,6 +133,7 @@ namespace {
 
             io::stream<skse_data_source> stream(skse_data_source(static_cast<consts>(type) == consts::storage_chunk ? intfc : nullptr));
             domain_master::master::instance().read_from_stream(stream);
+            write_profiling_report("load");
         });
     }
 
@@ -249,6 +269,13 @@ namespace {
                 }
             });
 
+            // every domain's JValue.evalLua* finds contexts ready. JContainers.setLuaContextPoolLimits changes the number
+            auto& master = domain_master::master::instance();
+            lua::prewarm_contexts(master.get_default_domain(), JC_LUA_PREWARMED_CONTEXTS);
+            for (auto& domName : master.active_domain_names) {
+                lua::prewarm_contexts(master.get_or_create_domain_with_name(domName), JC_LUA_PREWARMED_CONTEXTS);
+            }
+
             return true;
         }
 
@@ -263,6 +290,9 @@ namespace {
             g_serialization->SetSaveCallback(g_pluginHandle, save);
             g_serialization->SetLoadCallback(g_pluginHandle, load);
 
+#if JC_BATCH_FORM_DELETION
+            domain_master::master::instance().get_form_observer().set_deletion_batching(&collections::post_background_task);
+#endif
             g_serialization->SetFormDeleteCallback(g_pluginHandle, [](UInt64 handle) {
                 domain_master::master::instance().get_form_observer().on_form_deleted((forms::FormHandle)handle);
             });
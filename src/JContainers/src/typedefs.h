@@ -1,6 +1,7 @@
 #pragma once
 
 #include <assert.h>
+#include <stdarg.h>
 #include <type_traits>
 
 #   define STR(...)     __STR(__VA_ARGS__)
@@ -36,5 +37,9 @@ extern void JC_log(const char* fmt, va_list& args);
 
 #   endif
 
+#ifdef _MSC_VER
 __declspec(noreturn) inline void noreturn_func() {}
+#else
+[[noreturn]] inline void noreturn_func() { __builtin_unreachable(); }
+#endif
 
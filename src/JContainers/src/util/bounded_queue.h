@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * A lock-free bounded multi-producer multi-consumer queue (D. Vyukov's design): each cell carries a sequence
+ * number which tells whether the cell is ready for a producer or a consumer. Neither side ever waits,
+ * try_push fails if the queue is full, try_pop if it's empty.
+ */
+
+namespace util {
+
+    template<class T>
+    class bounded_queue {
+
+        struct cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        const size_t _mask;
+        std::unique_ptr<cell[]> _cells;
+        alignas(64) std::atomic<size_t> _enqueue_pos{ 0 };
+        alignas(64) std::atomic<size_t> _dequeue_pos{ 0 };
+
+    public:
+
+        /// @capacity must be a power of two
+        explicit bounded_queue(size_t capacity)
+            : _mask(capacity - 1)
+            , _cells(new cell[capacity])
+        {
+            for (size_t i = 0; i < capacity; ++i) {
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool try_push(const T& value) {
+            size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell& c = _cells[pos & _mask];
+                const size_t seq = c.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0) {
+                    if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        c.value = value;
+                        c.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = _enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool try_pop(T& value) {
+            size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+            for (;;) {
+                cell& c = _cells[pos & _mask];
+                const size_t seq = c.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (diff == 0) {
+                    if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        value = c.value;
+                        c.sequence.store(pos + _mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = _dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    };
+}
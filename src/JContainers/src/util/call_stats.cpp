@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "jansson.h"
+
+#include "util/call_stats.h"
+
+namespace util { namespace call_stats {
+
+    namespace {
+
+        // written by the owning thread only, so a relaxed load and store are enough
+        struct counters {
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> nanoseconds;
+            std::atomic<uint64_t> buckets[bucket_count];
+        };
+
+        struct totals {
+            uint64_t calls = 0;
+            uint64_t nanoseconds = 0;
+            uint64_t buckets[bucket_count] = {};
+        };
+
+        void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        size_t bucket_of(uint64_t nanoseconds) {
+            size_t bucket = 0;
+            while ((nanoseconds >>= 1) != 0 && bucket < bucket_count - 1) {
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        struct thread_block;
+
+        struct registry {
+            std::mutex mutex;
+            std::vector<std::string> names{ std::string() };  // the slot 0 is never counted
+            std::vector<thread_block*> threads;
+            std::vector<totals> retired{ max_functions };     // the counters of the exited threads
+            std::vector<totals> baseline{ max_functions };
+        };
+
+        // never destroyed: threads may exit after the static objects are gone
+        registry& instance() {
+            static registry* r = new registry();
+            return *r;
+        }
+
+        struct thread_block {
+            std::unique_ptr<counters[]> functions{ new counters[max_functions]() };
+
+            thread_block() {
+                auto& r = instance();
+                std::lock_guard<std::mutex> g{ r.mutex };
+                r.threads.push_back(this);
+            }
+
+            ~thread_block() {
+                auto& r = instance();
+                std::lock_guard<std::mutex> g{ r.mutex };
+                add_to(r.retired);
+                r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), this), r.threads.end());
+            }
+
+            void add_to(std::vector<totals>& sums) const {
+                for (uint32_t i = 0; i < max_functions; ++i) {
+                    auto& f = functions[i];
+                    auto& sum = sums[i];
+                    sum.calls += f.calls.load(std::memory_order_relaxed);
+                    sum.nanoseconds += f.nanoseconds.load(std::memory_order_relaxed);
+                    for (size_t b = 0; b < bucket_count; ++b) {
+                        sum.buckets[b] += f.buckets[b].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        thread_local thread_block t_block;
+
+        // the registry must be locked
+        std::vector<totals> u_current(registry& r) {
+            std::vector<totals> sums = r.retired;
+            for (auto thread : r.threads) {
+                thread->add_to(sums);
+            }
+            return sums;
+        }
+    }
+
+    uint32_t register_function(const char* class_name, const char* function_name) {
+        auto& r = instance();
+        std::lock_guard<std::mutex> g{ r.mutex };
+        if (r.names.size() >= max_functions) {
+            return 0;
+        }
+        r.names.push_back(std::string(class_name ? class_name : "") + "." + (function_name ? function_name : ""));
+        return (uint32_t)r.names.size() - 1;
+    }
+
+    void record(uint32_t function, uint64_t nanoseconds) {
+        auto& f = t_block.functions[function];
+        bump(f.calls, 1);
+        bump(f.nanoseconds, nanoseconds);
+        bump(f.buckets[bucket_of(nanoseconds)], 1);
+    }
+
+    std::vector<function_stats> snapshot() {
+        auto& r = instance();
+        std::vector<function_stats> result;
+        {
+            std::lock_guard<std::mutex> g{ r.mutex };
+            auto sums = u_current(r);
+            for (uint32_t i = 1; i < r.names.size(); ++i) {
+                auto& sum = sums[i];
+                auto& base = r.baseline[i];
+                if (sum.calls == base.calls) {
+                    continue;
+                }
+
+                function_stats stats;
+                stats.name = r.names[i];
+                stats.calls = sum.calls - base.calls;
+                stats.nanoseconds = sum.nanoseconds - base.nanoseconds;
+                for (size_t b = 0; b < bucket_count; ++b) {
+                    stats.buckets[b] = sum.buckets[b] - base.buckets[b];
+                }
+                result.push_back(std::move(stats));
+            }
+        }
+
+        std::sort(result.begin(), result.end(), [](const function_stats& l, const function_stats& r) {
+            return l.nanoseconds > r.nanoseconds;
+        });
+        return result;
+    }
+
+    void reset() {
+        auto& r = instance();
+        std::lock_guard<std::mutex> g{ r.mutex };
+        r.baseline = u_current(r);
+    }
+
+    namespace {
+
+        std::unique_ptr<json_t, decltype(&json_decref)> snapshot_to_json() {
+            std::unique_ptr<json_t, decltype(&json_decref)> js(json_object(), &json_decref);
+
+            uint64_t total_calls = 0, total_nanoseconds = 0;
+            json_t* functions = json_array();
+            for (auto& stats : snapshot()) {
+                total_calls += stats.calls;
+                total_nanoseconds += stats.nanoseconds;
+
+                json_t* function = json_object();
+                json_object_set_new(function, "name", json_string(stats.name.c_str()));
+                json_object_set_new(function, "calls", json_integer((json_int_t)stats.calls));
+                json_object_set_new(function, "seconds", json_real(stats.nanoseconds / 1e9));
+                json_object_set_new(function, "averageMicroseconds", json_real(stats.nanoseconds / 1e3 / stats.calls));
+
+                // trailing empty buckets are left out
+                size_t used = bucket_count;
+                while (used > 0 && stats.buckets[used - 1] == 0) {
+                    --used;
+                }
+                json_t* histogram = json_array();
+                for (size_t b = 0; b < used; ++b) {
+                    json_array_append_new(histogram, json_integer((json_int_t)stats.buckets[b]));
+                }
+                json_object_set_new(function, "log2NanosecondsHistogram", histogram);
+
+                json_array_append_new(functions, function);
+            }
+
+            json_object_set_new(js.get(), "calls", json_integer((json_int_t)total_calls));
+            json_object_set_new(js.get(), "seconds", json_real(total_nanoseconds / 1e9));
+            json_object_set_new(js.get(), "functions", functions);
+            return js;
+        }
+    }
+
+    std::string snapshot_as_json() {
+        auto js = snapshot_to_json();
+        std::unique_ptr<char, decltype(&free)> data(json_dumps(js.get(), JSON_INDENT(2)), &free);
+        return data ? std::string(data.get()) : std::string();
+    }
+
+    bool write_snapshot_to_file(const char* path) {
+        if (!path) {
+            return false;
+        }
+        auto js = snapshot_to_json();
+        return json_dump_file(js.get(), path, JSON_INDENT(2)) == 0;
+    }
+
+}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Always-on counters of the Papyrus API calls: call count, total time and a log2 histogram
+/// of the call durations per function. Each thread counts into its own block, a snapshot sums them up
+namespace util { namespace call_stats {
+
+    using clock = std::chrono::steady_clock;
+
+    /// Bucket i counts the calls which took [2^i, 2^(i+1)) nanoseconds, the last one is open-ended
+    static const size_t bucket_count = 32;
+    static const uint32_t max_functions = 512;
+
+    struct function_stats {
+        std::string name;
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t buckets[bucket_count] = {};
+    };
+
+    /// Gives the function a slot for its counters. Returns 0 (not counted) once all slots are taken
+    uint32_t register_function(const char* class_name, const char* function_name);
+
+    void record(uint32_t function, uint64_t nanoseconds);
+
+    /// The functions called at least once since the last reset, the most time-consuming first
+    std::vector<function_stats> snapshot();
+
+    /// Starts counting from zero. The counting threads aren't stopped: the current numbers become the baseline
+    void reset();
+
+    std::string snapshot_as_json();
+    bool write_snapshot_to_file(const char* path);
+
+    /// Times the calls of a registered function, does nothing for the slot 0
+    class scope {
+    public:
+        explicit scope(uint32_t function) : _function(function) {
+            if (_function) {
+                _started = clock::now();
+            }
+        }
+
+        ~scope() {
+            if (_function) {
+                record(_function, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - _started).count());
+            }
+        }
+
+    private:
+        uint32_t _function;
+        clock::time_point _started;
+    };
+
+}
+}
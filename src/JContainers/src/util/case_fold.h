@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#   define JC_CASE_FOLD_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+/**
+ * ASCII-only case folding and case-insensitive comparison. Same results as `_stricmp` in the "C"
+ * locale (non-ASCII bytes compare as is), but 16 bytes per step and no locale lookups.
+ */
+
+namespace util { namespace case_fold {
+
+    inline char fold(char c) {
+        return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+    }
+
+#ifdef JC_CASE_FOLD_SSE2
+    inline __m128i fold16(__m128i v) {
+        // bytes above 0x7F are negative and never fall into ['A', 'Z']
+        const __m128i upper = _mm_and_si128(
+            _mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+            _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+        return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+    }
+#endif
+
+    /// Writes @n folded characters of @src into @dst. @dst may be equal to @src
+    inline void fold(char* dst, const char* src, size_t n) {
+        size_t i = 0;
+#ifdef JC_CASE_FOLD_SSE2
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), fold16(v));
+        }
+#endif
+        for (; i < n; ++i) {
+            dst[i] = fold(src[i]);
+        }
+    }
+
+    inline void fold(std::string& s) {
+        fold(&s[0], s.data(), s.size());
+    }
+
+    inline std::string folded_copy(std::string_view s) {
+        std::string result(s.size(), '\0');
+        fold(&result[0], s.data(), s.size());
+        return result;
+    }
+
+    /// Three-way case-insensitive comparison of the first @n characters
+    inline int compare(const char* l, const char* r, size_t n) {
+        size_t i = 0;
+#ifdef JC_CASE_FOLD_SSE2
+        for (; i + 16 <= n; i += 16) {
+            __m128i lv = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(l + i)));
+            __m128i rv = fold16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(lv, rv)) != 0xFFFF) {
+                break; // the difference is somewhere in this block, the scalar loop finds it
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            unsigned char lc = (unsigned char)fold(l[i]), rc = (unsigned char)fold(r[i]);
+            if (lc != rc) {
+                return lc < rc ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    inline int compare(std::string_view l, std::string_view r) {
+        int result = compare(l.data(), r.data(), (std::min)(l.size(), r.size()));
+        if (result != 0) {
+            return result;
+        }
+        return l.size() == r.size() ? 0 : (l.size() < r.size() ? -1 : 1);
+    }
+
+    inline bool equals(std::string_view l, std::string_view r) {
+        return l.size() == r.size() && compare(l.data(), r.data(), l.size()) == 0;
+    }
+
+    /// FNV-1a of an already folded string
+    inline uint32_t hash(std::string_view folded) {
+        uint32_t h = 2166136261u;
+        for (unsigned char c : folded) {
+            h = (h ^ c) * 16777619u;
+        }
+        return h;
+    }
+}
+}
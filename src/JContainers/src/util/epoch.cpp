@@ -0,0 +1,99 @@
+#include <atomic>
+
+#include "util/epoch.h"
+
+namespace util { namespace epoch {
+
+    namespace {
+
+        // a thread's pin, reused by the later threads once the owner exits
+        struct record {
+            std::atomic<value> pinned{ 0 };         // 0 - not pinned
+            std::atomic<bool> in_use{ true };
+            uint32_t depth = 0;                     // the owner thread only
+            record* next = nullptr;                 // records are never freed, the list only grows
+        };
+
+        struct registry {
+            std::atomic<value> epoch{ 1 };
+            std::atomic<record*> records{ nullptr };
+        };
+
+        // never destroyed: threads may exit after the static objects are gone
+        registry& instance() {
+            static registry* r = new registry();
+            return *r;
+        }
+
+        record* acquire_record() {
+            auto& r = instance();
+            for (record* rec = r.records.load(std::memory_order_acquire); rec; rec = rec->next) {
+                bool taken = false;
+                if (!rec->in_use.load(std::memory_order_relaxed)
+                    && rec->in_use.compare_exchange_strong(taken, true, std::memory_order_acquire))
+                {
+                    return rec;
+                }
+            }
+
+            record* rec = new record();
+            record* head = r.records.load(std::memory_order_relaxed);
+            do {
+                rec->next = head;
+            } while (!r.records.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+            return rec;
+        }
+
+        struct thread_record {
+            record* rec = acquire_record();
+
+            ~thread_record() {
+                rec->depth = 0;
+                rec->pinned.store(0, std::memory_order_release);
+                rec->in_use.store(false, std::memory_order_release);
+            }
+        };
+
+        record& this_thread() {
+            thread_local thread_record t;
+            return *t.rec;
+        }
+    }
+
+    void pin() {
+        record& rec = this_thread();
+        if (rec.depth++ == 0) {
+            // seq_cst: the later reads of the shared structures can't be reordered before the pin
+            rec.pinned.store(instance().epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+        }
+    }
+
+    void unpin() {
+        record& rec = this_thread();
+        if (--rec.depth == 0) {
+            rec.pinned.store(0, std::memory_order_release);
+        }
+    }
+
+    bool is_pinned() {
+        return this_thread().depth > 0;
+    }
+
+    value retire_tag() {
+        return instance().epoch.load(std::memory_order_seq_cst);
+    }
+
+    value reclaim_bound() {
+        auto& r = instance();
+        value bound = r.epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+        for (record* rec = r.records.load(std::memory_order_acquire); rec; rec = rec->next) {
+            value pinned = rec->pinned.load(std::memory_order_seq_cst);
+            if (pinned != 0 && pinned < bound) {
+                bound = pinned;
+            }
+        }
+        return bound;
+    }
+
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+/// Epoch-based protection of the memory other threads may free. A thread pins the current epoch while it
+/// accesses shared objects it doesn't own; an object unlinked (retired) at the epoch E gets freed once every
+/// thread which might have seen it, i.e. pinned at E or earlier, has unpinned. Pinning writes a thread-own
+/// slot only, the shared objects' cache lines stay untouched
+namespace util { namespace epoch {
+
+    using value = uint64_t;
+
+    /// Pins the calling thread until the paired @unpin call. Nested pins are allowed and cost nothing
+    void pin();
+    void unpin();
+
+    /// Pins the calling thread for its lifetime
+    class guard {
+    public:
+        guard() { pin(); }
+        ~guard() { unpin(); }
+
+        guard(const guard&) = delete;
+        guard& operator = (const guard&) = delete;
+    };
+
+    bool is_pinned();
+
+    /// The tag of an object which has just been unlinked: no thread pinned after this call can reach it
+    value retire_tag();
+
+    /// Advances the epoch. The objects tagged below the returned bound are unreachable for any pinned thread
+    value reclaim_bound();
+
+}
+}
@@ -1,22 +1,24 @@
 #pragma once
 
 #include <string.h>
+#include "util/case_fold.h"
 
 namespace util {
 
     struct istring_traits : public std::char_traits<char> {
 
         static bool eq(char c1, char c2) {
-            return tolower(c1) == tolower(c2);
+            return case_fold::fold(c1) == case_fold::fold(c2);
         }
         static bool lt(char c1, char c2) {
-            return tolower(c1) < tolower(c2);
+            return (unsigned char)case_fold::fold(c1) < (unsigned char)case_fold::fold(c2);
         }
         static int compare(const char* s1, const char* s2, size_t n) {
-            return n > 0 ? _stricmp(s1, s2) : 0;
+            return case_fold::compare(s1, s2, n);
         }
         static const char* find(const char* s, int n, char a) {
-            while (n-- > 0 && tolower(*s) != tolower(a)) {
+            const char folded = case_fold::fold(a);
+            while (n-- > 0 && case_fold::fold(*s) != folded) {
                 ++s;
             }
             return s;
@@ -1,12 +1,22 @@
 #include "skse/skse.h"
 
+#ifdef JC_CORE
+#   include <cstdio>
+#endif
+
 void JC_log(const char* fmt, va_list& args) {
     va_list	args_copy;
 
     va_copy(args_copy, args);
 
     skse::console_print(fmt, args);
+#ifdef JC_CORE
+    // no SKSE log in the core build, the benchmarks print their timings this way
+    vprintf(fmt, args_copy);
+    putchar('\n');
+#else
     gLog.Log(IDebugLog::kLevel_Message, fmt, args_copy);
+#endif
 
     va_end(args_copy);
 }
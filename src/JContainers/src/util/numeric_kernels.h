@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#   define JC_NUMERIC_KERNELS_SSE2 1
+#   include <emmintrin.h>
+#endif
+
+/**
+ * Aggregates over packed int32/float arrays, 4 lanes per step with SSE2 and a scalar tail.
+ * Integer sums wrap around on overflow, same as the scalar int32 sum would.
+ */
+
+namespace util { namespace numeric {
+
+#ifdef JC_NUMERIC_KERNELS_SSE2
+    namespace detail {
+
+        inline int32_t lane(__m128i v, int i) {
+            alignas(16) int32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+            return lanes[i];
+        }
+
+        inline float lane(__m128 v, int i) {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            return lanes[i];
+        }
+
+        // SSE2 lacks _mm_min_epi32/_mm_max_epi32
+        inline __m128i min_epi32(__m128i a, __m128i b) {
+            __m128i gt = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+        }
+
+        inline __m128i max_epi32(__m128i a, __m128i b) {
+            __m128i gt = _mm_cmpgt_epi32(a, b);
+            return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+        }
+    }
+#endif
+
+    inline int32_t sum(const int32_t* data, size_t n) {
+        uint32_t result = 0;
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128i acc = _mm_setzero_si128();
+            for (; i + 4 <= n; i += 4) {
+                acc = _mm_add_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result += (uint32_t)detail::lane(acc, l);
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result += (uint32_t)data[i];
+        }
+        return (int32_t)result;
+    }
+
+    inline float sum(const float* data, size_t n) {
+        float result = 0.f;
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128 acc = _mm_setzero_ps();
+            for (; i + 4 <= n; i += 4) {
+                acc = _mm_add_ps(acc, _mm_loadu_ps(data + i));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result += detail::lane(acc, l);
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result += data[i];
+        }
+        return result;
+    }
+
+    /// @n must not be zero
+    inline int32_t min(const int32_t* data, size_t n) {
+        int32_t result = data[0];
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            for (i = 4; i + 4 <= n; i += 4) {
+                acc = detail::min_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result = (std::min)(result, detail::lane(acc, l));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result = (std::min)(result, data[i]);
+        }
+        return result;
+    }
+
+    /// @n must not be zero
+    inline int32_t max(const int32_t* data, size_t n) {
+        int32_t result = data[0];
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            for (i = 4; i + 4 <= n; i += 4) {
+                acc = detail::max_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result = (std::max)(result, detail::lane(acc, l));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result = (std::max)(result, data[i]);
+        }
+        return result;
+    }
+
+    /// @n must not be zero
+    inline float min(const float* data, size_t n) {
+        float result = data[0];
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128 acc = _mm_loadu_ps(data);
+            for (i = 4; i + 4 <= n; i += 4) {
+                acc = _mm_min_ps(acc, _mm_loadu_ps(data + i));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result = (std::min)(result, detail::lane(acc, l));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result = (std::min)(result, data[i]);
+        }
+        return result;
+    }
+
+    /// @n must not be zero
+    inline float max(const float* data, size_t n) {
+        float result = data[0];
+        size_t i = 0;
+#ifdef JC_NUMERIC_KERNELS_SSE2
+        if (n >= 4) {
+            __m128 acc = _mm_loadu_ps(data);
+            for (i = 4; i + 4 <= n; i += 4) {
+                acc = _mm_max_ps(acc, _mm_loadu_ps(data + i));
+            }
+            for (int l = 0; l < 4; ++l) {
+                result = (std::max)(result, detail::lane(acc, l));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            result = (std::max)(result, data[i]);
+        }
+        return result;
+    }
+}
+}
@@ -0,0 +1,182 @@
+#include <mutex>
+#include <memory>
+
+#include "jansson.h"
+
+#include "util/profiling.h"
+
+namespace util { namespace profiling {
+
+    namespace {
+
+        thread_local report* g_current = nullptr;
+
+        std::mutex g_last_mutex;
+        std::map<std::string, std::string> g_last;
+
+        double seconds_since(report::clock::time_point started) {
+            return std::chrono::duration<double>(report::clock::now() - started).count();
+        }
+
+        json_t* usage_to_json(const report::usage& u) {
+            json_t* js = json_object();
+            json_object_set_new(js, "seconds", json_real(u.seconds));
+            json_object_set_new(js, "bytes", json_integer((json_int_t)u.bytes));
+            json_object_set_new(js, "objects", json_integer((json_int_t)u.objects));
+            return js;
+        }
+
+        std::unique_ptr<json_t, decltype(&json_decref)> report_to_json(const report& r) {
+            auto js = std::unique_ptr<json_t, decltype(&json_decref)>(json_object(), &json_decref);
+
+            json_object_set_new(js.get(), "operation", json_string(r.operation().c_str()));
+            json_object_set_new(js.get(), "seconds", json_real(r.total_seconds()));
+            json_object_set_new(js.get(), "bytes", json_integer((json_int_t)r.total_bytes()));
+
+            json_t* phases = json_array();
+            for (auto& p : r.phases()) {
+                json_t* phase = json_object();
+                json_object_set_new(phase, "name", json_string(p.name.c_str()));
+                json_object_set_new(phase, "seconds", json_real(p.seconds));
+                json_object_set_new(phase, "bytes", json_integer((json_int_t)p.bytes));
+                json_array_append_new(phases, phase);
+            }
+            json_object_set_new(js.get(), "phases", phases);
+
+            json_t* domains = json_object();
+            for (auto& pair : r.domains()) {
+                json_object_set_new(domains, pair.first.c_str(), usage_to_json(pair.second));
+            }
+            json_object_set_new(js.get(), "domains", domains);
+
+            json_t* types = json_object();
+            for (auto& pair : r.types()) {
+                json_object_set_new(types, pair.first.c_str(), usage_to_json(pair.second));
+            }
+            json_object_set_new(js.get(), "types", types);
+
+            return js;
+        }
+    }
+
+    report::report(const char* operation)
+        : _operation(operation ? operation : "")
+    {}
+
+    report* report::current() {
+        return g_current;
+    }
+
+    std::string report::to_json() const {
+        auto js = report_to_json(*this);
+        std::unique_ptr<char, decltype(&free)> data(json_dumps(js.get(), JSON_INDENT(2)), &free);
+        return data ? std::string(data.get()) : std::string();
+    }
+
+    bool report::write_to_file(const char* path) const {
+        if (!path) {
+            return false;
+        }
+        auto js = report_to_json(*this);
+        return json_dump_file(js.get(), path, JSON_INDENT(2)) == 0;
+    }
+
+    std::string report::last_as_json(const char* operation) {
+        std::lock_guard<std::mutex> g(g_last_mutex);
+        auto itr = g_last.find(operation ? operation : "");
+        return itr != g_last.end() ? itr->second : std::string();
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+
+    report::attach::attach(report& r, const counting_streambuf& counter)
+        : _report(r)
+        , _previous(g_current)
+        , _started(clock::now())
+    {
+        _report._counter = &counter;
+        g_current = &_report;
+    }
+
+    report::attach::~attach() {
+        g_current = _previous;
+
+        _report._total_seconds = seconds_since(_started);
+        _report._total_bytes = _report.bytes();
+        _report._counter = nullptr;
+
+        auto json = _report.to_json();
+        std::lock_guard<std::mutex> g(g_last_mutex);
+        g_last[_report._operation] = std::move(json);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+
+    phase_scope::phase_scope(const char* name)
+        : _report(report::current())
+        , _name(name)
+    {
+        if (_report) {
+            _started = report::clock::now();
+            _bytes = _report->bytes();
+        }
+    }
+
+    phase_scope::~phase_scope() {
+        if (_report) {
+            std::string name = _report->_domain.empty() ? _name : _report->_domain + "." + _name;
+            _report->_phases.push_back({ std::move(name), seconds_since(_started), _report->bytes() - _bytes });
+        }
+    }
+
+    domain_scope::domain_scope(const std::string& name)
+        : _report(report::current())
+    {
+        if (_report) {
+            _previous = std::move(_report->_domain);
+            _report->_domain = name;
+            _started = report::clock::now();
+            _bytes = _report->bytes();
+        }
+    }
+
+    domain_scope::~domain_scope() {
+        if (_report) {
+            auto& u = _report->_domains[_report->_domain];
+            u.seconds += seconds_since(_started);
+            u.bytes += _report->bytes() - _bytes;
+            _report->_domain = std::move(_previous);
+        }
+    }
+
+    object_scope::object_scope(const char* type_name)
+        : _report(report::current())
+        , _type_name(type_name)
+    {
+        if (_report) {
+            _report->_objects.push_back({ _report->bytes(), 0 });
+        }
+    }
+
+    object_scope::~object_scope() {
+        if (_report) {
+            auto frame = _report->_objects.back();
+            _report->_objects.pop_back();
+
+            uint64_t total = _report->bytes() - frame.started;
+            if (!_report->_objects.empty()) {
+                _report->_objects.back().children += total;
+            }
+
+            auto& u = _report->_types[_type_name];
+            u.bytes += total - frame.children;
+            u.objects += 1;
+
+            if (!_report->_domain.empty()) {
+                _report->_domains[_report->_domain].objects += 1;
+            }
+        }
+    }
+
+}
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include <streambuf>
+
+/// Save/load profiling: phase timings, bytes per domain and bytes per collection type
+namespace util { namespace profiling {
+
+    /// Pass-through stream buffer, counts the characters which go through it
+    class counting_streambuf : public std::streambuf {
+    public:
+        explicit counting_streambuf(std::streambuf* source) : _source(source) {}
+
+        uint64_t count() const { return _count; }
+
+    protected:
+        int_type underflow() override {
+            return _source->sgetc();
+        }
+
+        int_type uflow() override {
+            int_type c = _source->sbumpc();
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                ++_count;
+            }
+            return c;
+        }
+
+        std::streamsize xsgetn(char* s, std::streamsize n) override {
+            std::streamsize read = _source->sgetn(s, n);
+            _count += read;
+            return read;
+        }
+
+        int_type overflow(int_type c) override {
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            int_type written = _source->sputc(traits_type::to_char_type(c));
+            if (!traits_type::eq_int_type(written, traits_type::eof())) {
+                ++_count;
+            }
+            return written;
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            std::streamsize written = _source->sputn(s, n);
+            _count += written;
+            return written;
+        }
+
+        int sync() override {
+            return _source->pubsync();
+        }
+
+    private:
+        std::streambuf* _source;
+        uint64_t _count = 0;
+    };
+
+    /// Collects the numbers of a single save or load operation
+    class report {
+    public:
+        using clock = std::chrono::high_resolution_clock;
+
+        struct phase {
+            std::string name;
+            double seconds;
+            uint64_t bytes;
+        };
+
+        struct usage {
+            double seconds = 0;
+            uint64_t bytes = 0;
+            uint64_t objects = 0;
+        };
+
+        explicit report(const char* operation);
+
+        const std::string& operation() const { return _operation; }
+        const std::vector<phase>& phases() const { return _phases; }
+        const std::map<std::string, usage>& domains() const { return _domains; }
+        const std::map<std::string, usage>& types() const { return _types; }
+        double total_seconds() const { return _total_seconds; }
+        uint64_t total_bytes() const { return _total_bytes; }
+
+        /// Bytes which went through the attached stream so far (0 if none attached)
+        uint64_t bytes() const { return _counter ? _counter->count() : 0; }
+
+        std::string to_json() const;
+        bool write_to_file(const char* path) const;
+
+        /// The report attached to the current thread, if any
+        static report* current();
+
+        /// Last finished report of given operation ("save" or "load") as JSON, empty if none
+        static std::string last_as_json(const char* operation);
+
+        /// Attaches the report (and the stream counter) to the current thread,
+        /// on destruction finishes the report and publishes it as the last one
+        class attach {
+        public:
+            attach(report& r, const counting_streambuf& counter);
+            ~attach();
+        private:
+            report& _report;
+            report* _previous;
+            clock::time_point _started;
+        };
+
+    private:
+        friend class phase_scope;
+        friend class domain_scope;
+        friend class object_scope;
+
+        struct object_frame {
+            uint64_t started;
+            uint64_t children;
+        };
+
+        std::string _operation;
+        std::vector<phase> _phases;
+        std::map<std::string, usage> _domains;
+        std::map<std::string, usage> _types;
+        std::vector<object_frame> _objects;
+        std::string _domain;
+        double _total_seconds = 0;
+        uint64_t _total_bytes = 0;
+        const counting_streambuf* _counter = nullptr;
+    };
+
+    /// Measures a phase of the current report. Phases which run inside a domain_scope are prefixed
+    /// with the domain name. Does nothing when no report is attached.
+    class phase_scope {
+    public:
+        explicit phase_scope(const char* name);
+        ~phase_scope();
+    private:
+        report* _report;
+        const char* _name;
+        report::clock::time_point _started;
+        uint64_t _bytes;
+    };
+
+    /// Measures time and bytes spent on a domain
+    class domain_scope {
+    public:
+        explicit domain_scope(const std::string& name);
+        ~domain_scope();
+    private:
+        report* _report;
+        std::string _previous;
+        report::clock::time_point _started;
+        uint64_t _bytes;
+    };
+
+    /// Accounts the bytes of a single serialized object to its type. Nested objects (which boost
+    /// serializes in-place) are excluded from the parent's size.
+    class object_scope {
+    public:
+        explicit object_scope(const char* type_name);
+        ~object_scope();
+    private:
+        report* _report;
+        const char* _type_name;
+    };
+
+}
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   include <immintrin.h>
+#   define JC_SCAN_KERNELS_AVX2 1
+#   define JC_AVX2_FUNCTION
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   include <immintrin.h>
+#   define JC_SCAN_KERNELS_AVX2 1
+#   define JC_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+
+/**
+ * Equality scans over packed int32/float arrays: find, reverse find, count and remove.
+ * AVX2 (8 lanes) if the CPU supports it, scalar loop otherwise. Float lanes compare with ==,
+ * so NaN never matches and 0.0 matches -0.0, the same as item comparison does.
+ */
+
+namespace util { namespace scan {
+
+#ifdef JC_SCAN_KERNELS_AVX2
+    namespace detail {
+
+        inline bool cpu_has_avx2() {
+#   ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) {
+                return false;
+            }
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) { // the OS saves YMM registers
+                return false;
+            }
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#   else
+            return __builtin_cpu_supports("avx2") != 0;
+#   endif
+        }
+
+        inline bool has_avx2() {
+            static const bool result = cpu_has_avx2();
+            return result;
+        }
+
+        // all bits of a lane are set if the lane of @data equals to @value
+        JC_AVX2_FUNCTION inline __m256i eq_lanes(const int32_t* data, __m256i value) {
+            return _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), value);
+        }
+
+        JC_AVX2_FUNCTION inline __m256i eq_lanes(const float* data, __m256 value) {
+            return _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(data), value, _CMP_EQ_OQ));
+        }
+
+        template<class T, class V>
+        JC_AVX2_FUNCTION int eq_mask(const T* data, V value) {
+            return _mm256_movemask_ps(_mm256_castsi256_ps(eq_lanes(data, value)));
+        }
+
+        JC_AVX2_FUNCTION inline __m256i splat(int32_t v) { return _mm256_set1_epi32(v); }
+        JC_AVX2_FUNCTION inline __m256 splat(float v) { return _mm256_set1_ps(v); }
+
+        template<class T>
+        JC_AVX2_FUNCTION size_t find_avx2(const T* data, size_t n, T value) {
+            const auto v = splat(value);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                if (eq_mask(data + i, v)) {
+                    break; // the block has the match, the scalar loop below stops at it
+                }
+            }
+            for (; i < n && !(data[i] == value); ++i) {}
+            return i;
+        }
+
+        template<class T>
+        JC_AVX2_FUNCTION size_t rfind_avx2(const T* data, size_t n, T value) {
+            const auto v = splat(value);
+            size_t end = n;
+            for (; end >= 8; end -= 8) {
+                if (eq_mask(data + end - 8, v)) {
+                    break;
+                }
+            }
+            for (size_t i = end; i > 0; --i) {
+                if (data[i - 1] == value) {
+                    return i - 1;
+                }
+            }
+            return n;
+        }
+
+        template<class T>
+        JC_AVX2_FUNCTION size_t count_avx2(const T* data, size_t n, T value) {
+            const auto v = splat(value);
+            __m256i matches = _mm256_setzero_si256(); // a matching lane is -1, so subtract
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                matches = _mm256_sub_epi32(matches, eq_lanes(data + i, v));
+            }
+
+            alignas(32) uint32_t lanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), matches);
+            size_t result = 0;
+            for (auto lane : lanes) {
+                result += lane;
+            }
+            for (; i < n; ++i) {
+                result += (data[i] == value);
+            }
+            return result;
+        }
+    }
+#endif
+
+    /// Index of the first element equal to @value, @n if none
+    template<class T>
+    size_t find(const T* data, size_t n, T value) {
+#ifdef JC_SCAN_KERNELS_AVX2
+        if (detail::has_avx2()) {
+            return detail::find_avx2(data, n, value);
+        }
+#endif
+        size_t i = 0;
+        for (; i < n && !(data[i] == value); ++i) {}
+        return i;
+    }
+
+    /// Index of the last element equal to @value, @n if none
+    template<class T>
+    size_t rfind(const T* data, size_t n, T value) {
+#ifdef JC_SCAN_KERNELS_AVX2
+        if (detail::has_avx2()) {
+            return detail::rfind_avx2(data, n, value);
+        }
+#endif
+        for (size_t i = n; i > 0; --i) {
+            if (data[i - 1] == value) {
+                return i - 1;
+            }
+        }
+        return n;
+    }
+
+    template<class T>
+    size_t count(const T* data, size_t n, T value) {
+#ifdef JC_SCAN_KERNELS_AVX2
+        if (detail::has_avx2()) {
+            return detail::count_avx2(data, n, value);
+        }
+#endif
+        size_t result = 0;
+        for (size_t i = 0; i < n; ++i) {
+            result += (data[i] == value);
+        }
+        return result;
+    }
+
+    /// Moves the elements not equal to @value to the front, keeping their order.
+    /// Returns the count of the elements left
+    template<class T>
+    size_t remove(T* data, size_t n, T value) {
+        size_t out = find(data, n, value);  // nothing moves before the first match
+        for (size_t i = out; i < n; ++i) {
+            if (!(data[i] == value)) {
+                data[out++] = data[i];
+            }
+        }
+        return out;
+    }
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <type_traits>
 
@@ -14,8 +15,10 @@ namespace util {
     public:
 
         spinlock() {
+#ifdef _MSC_VER
             // Likely the old's code here _lock._My_Val have been also an long.
             static_assert (sizeof (_lock._Storage._Storage._Value) == sizeof (long), "ABI compatibility, check serialization.");
+#endif
         }
 
         void lock() {
@@ -29,4 +32,49 @@ namespace util {
 
         typedef std::lock_guard<spinlock> guard;
     };
+
+    /// One-byte reader-writer spinlock: up to 127 readers at once or one writer. A waiting writer stops new readers
+    /// from entering, so a stream of readers can't starve it. Not recursive in either mode
+    class rw_spinlock
+    {
+        static const uint8_t writer = 1;        // held or awaited by a writer
+        static const uint8_t reader = 2;        // the rest of the bits count the readers
+        static const uint8_t max_readers = 0xFE;  // 127 readers in
+
+        std::atomic<uint8_t> _state{ 0 };
+
+    public:
+
+        void lock() {
+            uint8_t state = _state.load(std::memory_order_relaxed);
+            while ((state & writer) || !_state.compare_exchange_weak(state, (uint8_t)(state | writer), std::memory_order_acquire, std::memory_order_relaxed)) {
+                state = _state.load(std::memory_order_relaxed);
+            }
+            while (_state.load(std::memory_order_acquire) != writer)   // the readers which came first leave
+                ; // spin
+        }
+
+        bool try_lock() {
+            uint8_t state = 0;
+            return _state.compare_exchange_strong(state, writer, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() {
+            _state.store(0, std::memory_order_release);
+        }
+
+        void lock_shared() {
+            while (!try_lock_shared())
+                ; // spin
+        }
+
+        bool try_lock_shared() {
+            uint8_t state = _state.load(std::memory_order_relaxed);
+            return !(state & writer) && state != max_readers && _state.compare_exchange_strong(state, (uint8_t)(state + reader), std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock_shared() {
+            _state.fetch_sub(reader, std::memory_order_release);
+        }
+    };
 }
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+
+#include "util/spinlock.h"
+#include "util/case_fold.h"
+
+namespace util {
+
+    inline void fold_case(std::string& s) {
+        case_fold::fold(s);
+    }
+
+    inline std::string folded_copy(std::string_view s) {
+        return case_fold::folded_copy(s);
+    }
+
+    class interned_string;
+
+    /// The global pool of the interned strings. Entries are reference counted and get erased
+    /// once the last interned_string referencing them is gone.
+    class string_pool {
+    public:
+        struct entry {
+            std::string value;
+            entry* folded; // lower-case spelling of the @value, points to itself if @value is lower-case already
+            uint32_t hash; // case_fold::hash of the lower-case spelling
+            std::atomic<uint32_t> refs;
+        };
+
+        static string_pool& instance() {
+            // never destroyed: maps may outlive any static destruction order
+            static string_pool* pool = new string_pool();
+            return *pool;
+        }
+
+        entry* intern(std::string_view s) {
+            if (s.empty()) {
+                return nullptr;
+            }
+
+            auto folded = folded_copy(s);
+
+            spinlock::guard g(_lock);
+            entry* canonical = u_intern_exact(folded, nullptr).first;
+            if (folded == s) {
+                return canonical;
+            }
+
+            auto spelling = u_intern_exact(s, canonical);
+            if (!spelling.second) {
+                // an existing spelling references the @canonical already
+                --canonical->refs;
+            }
+            return spelling.first;
+        }
+
+        static void retain(entry* e) {
+            if (e) {
+                e->refs.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void release(entry* e) {
+            if (!e) {
+                return;
+            }
+
+            // fast path: not the last reference. The last one is dropped under the lock, the same
+            // lock intern() holds while resurrecting entries
+            uint32_t refs = e->refs.load(std::memory_order_relaxed);
+            while (refs > 1) {
+                if (e->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_release, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+
+            entry* folded = nullptr;
+            {
+                spinlock::guard g(_lock);
+                if (--e->refs != 0) {
+                    return;
+                }
+                _entries.erase(std::string_view(e->value));
+                folded = e->folded != e ? e->folded : nullptr;
+            }
+
+            delete e;
+            release(folded);
+        }
+
+        size_t size() const {
+            spinlock::guard g(_lock);
+            return _entries.size();
+        }
+
+    private:
+        string_pool() = default;
+
+        std::pair<entry*, bool> u_intern_exact(std::string_view s, entry* folded) {
+            auto itr = _entries.find(s);
+            if (itr != _entries.end()) {
+                ++itr->second->refs;
+                return{ itr->second, false };
+            }
+
+            auto e = new entry{ std::string(s), folded, folded ? folded->hash : case_fold::hash(s), { 1 } };
+            if (!folded) {
+                e->folded = e;
+            }
+            _entries.emplace(std::string_view(e->value), e);
+            return{ e, true };
+        }
+
+        mutable spinlock _lock;
+        std::unordered_map<std::string_view, entry*> _entries;
+    };
+
+    /// Case-preserving string interned in the string_pool. Strings which differ by case only
+    /// share the same folded entry, so case-insensitive equality is a pointer comparison.
+    class interned_string {
+    public:
+        using entry = string_pool::entry;
+
+        interned_string() = default;
+
+        interned_string(std::string_view s) : _entry(string_pool::instance().intern(s)) {}
+        interned_string(const std::string& s) : interned_string(std::string_view(s)) {}
+        interned_string(const char* s) : interned_string(s ? std::string_view(s) : std::string_view()) {}
+
+        interned_string(const interned_string& other) : _entry(other._entry) {
+            string_pool::retain(_entry);
+        }
+
+        interned_string(interned_string&& other) : _entry(other._entry) {
+            other._entry = nullptr;
+        }
+
+        interned_string& operator = (const interned_string& other) {
+            if (_entry != other._entry) {
+                string_pool::retain(other._entry);
+                string_pool::instance().release(_entry);
+                _entry = other._entry;
+            }
+            return *this;
+        }
+
+        interned_string& operator = (interned_string&& other) {
+            if (this != &other) {
+                string_pool::instance().release(_entry);
+                _entry = other._entry;
+                other._entry = nullptr;
+            }
+            return *this;
+        }
+
+        ~interned_string() {
+            string_pool::instance().release(_entry);
+        }
+
+        const std::string& str() const { return _entry ? _entry->value : empty_string(); }
+        const std::string& folded() const { return _entry ? _entry->folded->value : empty_string(); }
+
+        operator const std::string& () const { return str(); }
+
+        const char* c_str() const { return str().c_str(); }
+        size_t size() const { return str().size(); }
+        bool empty() const { return _entry == nullptr; }
+
+        /// Identity of the exact spelling
+        const void* id() const { return _entry; }
+        /// Identity of the case-folded spelling
+        const void* folded_id() const { return _entry ? _entry->folded : nullptr; }
+        /// Hash of the case-folded spelling, computed once per pool entry
+        uint32_t folded_hash() const { return _entry ? _entry->hash : case_fold::hash({}); }
+
+        /// Case-insensitive three-way comparison, same order as `_stricmp`. Folded spellings are
+        /// stored in the pool, so no folding happens here
+        int compare_folded(const interned_string& other) const {
+            return folded_id() == other.folded_id() ? 0 : folded().compare(other.folded());
+        }
+
+        friend bool operator == (const interned_string& l, const interned_string& r) { return l._entry == r._entry; }
+        friend bool operator != (const interned_string& l, const interned_string& r) { return l._entry != r._entry; }
+        friend bool operator == (const interned_string& l, const std::string& r) { return l.str() == r; }
+        friend bool operator == (const std::string& l, const interned_string& r) { return l == r.str(); }
+        friend bool operator == (const interned_string& l, const char* r) { return r && l.str() == r; }
+
+    private:
+        static const std::string& empty_string() {
+            static const std::string empty;
+            return empty;
+        }
+
+        entry* _entry = nullptr;
+    };
+
+    /// Lookup key for interned strings: folded and hashed once, compared without interning
+    struct folded_key {
+        std::string folded;
+        uint32_t hash;
+
+        explicit folded_key(std::string_view s) : folded(folded_copy(s)), hash(case_fold::hash(folded)) {}
+        explicit folded_key(const char* s) : folded_key(s ? std::string_view(s) : std::string_view()) {}
+    };
+
+    struct interned_string_case_insensitive_less {
+        using is_transparent = void;
+
+        bool operator() (const interned_string& l, const interned_string& r) const {
+            return l.compare_folded(r) < 0;
+        }
+        bool operator() (const interned_string& l, const folded_key& r) const {
+            return l.folded().compare(r.folded) < 0;
+        }
+        bool operator() (const folded_key& l, const interned_string& r) const {
+            return l.folded.compare(r.folded()) < 0;
+        }
+
+        /// Cheap equality check of the lower_bound result: hashes first, bytes if they match
+        static bool equals(const interned_string& l, const folded_key& r) {
+            return l.folded_hash() == r.hash && l.folded() == r.folded;
+        }
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <boost/serialization/split_free.hpp>
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/archive/archive_exception.hpp>
+
+#include "util/string_pool.h"
+
+/**
+ * Each distinct interned string is written into an archive once: the first occurrence writes
+ * its index followed by the characters, the next ones write the index only. The index tables
+ * live as long as the archive (see Boost's archive helpers).
+ */
+
+namespace util { namespace string_pool_serialization {
+
+    struct save_table {
+        std::unordered_map<const void*, uint32_t> indices;
+    };
+
+    struct load_table {
+        std::vector<interned_string> strings;
+    };
+
+    // unique address, identifies the helpers within an archive
+    inline void* helper_id() {
+        static const char id = 0;
+        return (void*)&id;
+    }
+}
+}
+
+namespace boost { namespace serialization {
+
+    template<class Archive>
+    void save(Archive& ar, const util::interned_string& s, unsigned int version) {
+        namespace sps = util::string_pool_serialization;
+        auto& table = ar.template get_helper<sps::save_table>(sps::helper_id());
+
+        auto result = table.indices.emplace(s.id(), (uint32_t)table.indices.size());
+        uint32_t index = result.first->second;
+        ar << index;
+        if (result.second) {
+            ar << s.str();
+        }
+    }
+
+    template<class Archive>
+    void load(Archive& ar, util::interned_string& s, unsigned int version) {
+        namespace sps = util::string_pool_serialization;
+        auto& table = ar.template get_helper<sps::load_table>(sps::helper_id());
+
+        uint32_t index = 0;
+        ar >> index;
+        if (index == table.strings.size()) {
+            std::string str;
+            ar >> str;
+            table.strings.emplace_back(str);
+        }
+        else if (index > table.strings.size()) {
+            throw boost::archive::archive_exception(boost::archive::archive_exception::input_stream_error);
+        }
+        s = table.strings[index];
+    }
+}
+}
+
+BOOST_SERIALIZATION_SPLIT_FREE(util::interned_string);
+BOOST_CLASS_IMPLEMENTATION(util::interned_string, boost::serialization::object_serializable)
+BOOST_CLASS_TRACKING(util::interned_string, boost::serialization::track_never)
@@ -1,4 +1,25 @@
 #include <boost/filesystem/path.hpp>
+
+#ifdef JC_CORE
+
+#include <boost/filesystem/operations.hpp>
+
+namespace util {
+
+    // the executable in the core build, there is no DLL
+    boost::filesystem::path dll_path() {
+        return boost::filesystem::read_symlink("/proc/self/exe");
+    }
+
+    boost::filesystem::path relative_to_dll_path(const char *relative_path) {
+        assert(relative_path);
+        auto imagePath = dll_path();
+        return (imagePath.remove_filename() /= relative_path);
+    }
+}
+
+#else
+
 #include <windef.h>
 
 namespace util {
@@ -48,3 +69,5 @@ BOOL APIENTRY DllMain(HMODULE /* hModule */,
     }
     return TRUE;
 }
+
+#endif
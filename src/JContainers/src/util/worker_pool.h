@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * A few background threads to split big read-only jobs (collection queries) into chunks.
+ * The instance is never destroyed: joining threads while the DLL unloads would deadlock.
+ */
+
+namespace util {
+
+    class worker_pool {
+
+        std::mutex _mutex;
+        std::condition_variable _has_work;
+        std::deque<std::function<void()>> _work;
+        size_t _thread_count = 0;
+
+        worker_pool() {
+            unsigned cores = std::thread::hardware_concurrency();
+            _thread_count = cores > 1 ? (std::min)(cores - 1, 7u) : 0; // the calling thread works too
+            for (size_t i = 0; i < _thread_count; ++i) {
+                std::thread([this]() { work(); }).detach();
+            }
+        }
+
+        void work() {
+            for (;;) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> g{ _mutex };
+                    _has_work.wait(g, [this]() { return !_work.empty(); });
+                    job = std::move(_work.front());
+                    _work.pop_front();
+                }
+                job();
+            }
+        }
+
+        bool try_run_one() {
+            std::function<void()> job;
+            {
+                std::lock_guard<std::mutex> g{ _mutex };
+                if (_work.empty()) {
+                    return false;
+                }
+                job = std::move(_work.front());
+                _work.pop_front();
+            }
+            job();
+            return true;
+        }
+
+    public:
+
+        static worker_pool& instance() {
+            static worker_pool* pool = new worker_pool();
+            return *pool;
+        }
+
+        size_t thread_count() const { return _thread_count; }
+
+        /// Calls @func(begin, end) for the chunks of [0, @count), each of at least @min_chunk elements.
+        /// Small inputs run on the calling thread. Returns when all chunks are done, even if some throw:
+        /// the first exception is rethrown then
+        void parallel_for(size_t count, size_t min_chunk, const std::function<void(size_t, size_t)>& func) {
+            const size_t max_chunks = _thread_count + 1;
+            const size_t chunks = (std::min)(max_chunks, count / (std::max)(min_chunk, size_t(1)));
+            if (chunks <= 1) {
+                func(0, count);
+                return;
+            }
+
+            const size_t chunk_size = (count + chunks - 1) / chunks;
+            std::atomic<size_t> left{ chunks - 1 };
+            std::mutex done_mutex;
+            std::condition_variable done;
+            std::exception_ptr error;   // the first one, guarded by the done_mutex
+
+            {
+                std::lock_guard<std::mutex> g{ _mutex };
+                for (size_t i = 1; i < chunks; ++i) {
+                    const size_t begin = i * chunk_size, end = (std::min)(count, begin + chunk_size);
+                    _work.emplace_back([&, begin, end]() {
+                        std::exception_ptr chunk_error;
+                        try {
+                            func(begin, end);
+                        }
+                        catch (...) {
+                            chunk_error = std::current_exception();
+                        }
+                        std::lock_guard<std::mutex> g{ done_mutex }; // the caller may not return before it's unlocked
+                        if (chunk_error && !error) {
+                            error = chunk_error;
+                        }
+                        if (--left == 0) {
+                            done.notify_one();
+                        }
+                    });
+                }
+            }
+            _has_work.notify_all();
+
+            std::exception_ptr own_error;
+            try {
+                func(0, chunk_size);
+            }
+            catch (...) {
+                own_error = std::current_exception(); // the queued chunks still refer to this frame, wait for them first
+            }
+
+            // helps with the queued chunks (own or other callers') instead of idling
+            while (left > 0 && try_run_one()) {}
+
+            std::unique_lock<std::mutex> g{ done_mutex };
+            done.wait(g, [&]() { return left == 0; });
+
+            if (own_error || error) {
+                std::rethrow_exception(own_error ? own_error : error);
+            }
+        }
+    };
+}
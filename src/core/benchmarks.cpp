@@ -0,0 +1,11 @@
+// The benchmark executable of the core build: the *_perft tests of collections/benchmarks.hpp, no game involved.
+// A --gtest_filter argument picks some of them
+
+#include "gtest.h"
+#include "collections/benchmarks.hpp"
+
+int main(int argc, char **argv) {
+    ::testing::GTEST_FLAG(filter) = "*_perft";
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
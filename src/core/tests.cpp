@@ -0,0 +1,5 @@
+// The test executable of the core build: the tests of object/ (compiled into jcontainers_core itself)
+// and collections/tests.h, no game involved
+
+#include "gtest.h"
+#include "collections/tests.h"